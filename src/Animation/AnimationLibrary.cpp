@@ -0,0 +1,69 @@
+#include "AnimationLibrary.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cmath>
+
+int AnimationLibrary::AddClip(const std::string& name, const std::vector<SDL_Rect>& frames, const std::vector<float>& durations, bool isLooping) {
+	if (frames.empty() || frames.size() != durations.size() || frames.size() > UINT16_MAX) {
+		LOG_ERROR(Assets, "The animation clip \"{}\" needs one duration per frame", name);
+		return -1;
+	}
+	if (clipIds.count(name)) {
+		LOG_ERROR(Assets, "There is already an animation clip \"{}\"", name);
+		return -1;
+	}
+
+	AnimationClip clip;
+	clip.firstFrame = static_cast<uint32_t>(frameRects.size());
+	clip.firstTick = static_cast<uint32_t>(tickFrames.size());
+	clip.numFrames = static_cast<int>(frames.size());
+	clip.isLooping = isLooping;
+
+	// every frame gets at least one tick
+	float frameEnd = 0.0f;
+	for (size_t frame = 0; frame < frames.size(); frame++) {
+		frameEnd += std::max(durations[frame], 0.0f);
+		const size_t endTick = std::max(static_cast<size_t>(std::lround(frameEnd * TICKS_PER_SECOND)), tickFrames.size() - clip.firstTick + 1);
+		tickFrames.resize(clip.firstTick + endTick, static_cast<uint16_t>(frame));
+	}
+	clip.numTicks = static_cast<int>(tickFrames.size() - clip.firstTick);
+	clip.duration = clip.numTicks / TICKS_PER_SECOND;
+	clip.inverseDuration = 1.0f / clip.duration;
+	frameRects.insert(frameRects.end(), frames.begin(), frames.end());
+
+	const int clipId = static_cast<int>(clips.size());
+	clips.push_back(clip);
+	clipIds.emplace(name, clipId);
+	LOG_DEBUG(Assets, "Animation clip \"{}\" added: {} frames, {} seconds", name, clip.numFrames, clip.duration);
+	return clipId;
+}
+
+int AnimationLibrary::AddStripClip(const std::string& name, int x, int y, int frameWidth, int frameHeight, int numFrames, float frameDuration, bool isLooping) {
+	std::vector<SDL_Rect> frames;
+	for (int frame = 0; frame < numFrames; frame++) {
+		frames.push_back({ x + frame * frameWidth, y, frameWidth, frameHeight });
+	}
+	return AddClip(name, frames, std::vector<float>(frames.size(), frameDuration), isLooping);
+}
+
+int AnimationLibrary::GetClipId(const std::string& name) const {
+	const auto clipId = clipIds.find(name);
+	return clipId != clipIds.end() ? clipId->second : -1;
+}
+
+int AnimationLibrary::GetNumClips() const {
+	return static_cast<int>(clips.size());
+}
+
+const AnimationClip& AnimationLibrary::GetClip(int clipId) const {
+	return clips[clipId];
+}
+
+const SDL_Rect& AnimationLibrary::GetFrameRect(const AnimationClip& clip, int frame) const {
+	return frameRects[clip.firstFrame + frame];
+}
+
+int AnimationLibrary::GetFrame(const AnimationClip& clip, float time) const {
+	const int tick = std::clamp(static_cast<int>(time * TICKS_PER_SECOND), 0, clip.numTicks - 1);
+	return tickFrames[clip.firstTick + tick];
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <SDL.h>
+
+// a clip of a spritesheet, the frames and their ticks lie in the packed tables of the AnimationLibrary
+struct AnimationClip {
+	uint32_t firstFrame; // in the frame rects
+	uint32_t firstTick; // in the tick frames
+	int numFrames;
+	int numTicks;
+	float duration; // in seconds
+	float inverseDuration;
+	bool isLooping; // else it stops on the last frame
+};
+
+// the animation clips shared by all the entities, filled at load time and only read afterwards
+// every clip gets a table with its frame for each tick (TICKS_PER_SECOND) of its duration,
+// so finding the frame of a time is one lookup instead of searching through the frame durations
+class AnimationLibrary {
+public:
+	static constexpr float TICKS_PER_SECOND = 1000.0f;
+
+private:
+	std::vector<AnimationClip> clips;
+	std::unordered_map<std::string, int> clipIds;
+	std::vector<SDL_Rect> frameRects; // the frames of all the clips, one clip after the other
+	std::vector<uint16_t> tickFrames; // [clip.firstTick + tick] = frame in the clip
+
+public:
+	// the frames get shown for their durations (in seconds) in order, -1 if the clip is invalid or the name is taken
+	int AddClip(const std::string& name, const std::vector<SDL_Rect>& frames, const std::vector<float>& durations, bool isLooping = true);
+	// numFrames frames of the same size next to each other in a spritesheet, starting at (x, y)
+	int AddStripClip(const std::string& name, int x, int y, int frameWidth, int frameHeight, int numFrames, float frameDuration, bool isLooping = true);
+
+	// -1 if there is no clip with the name
+	int GetClipId(const std::string& name) const;
+	int GetNumClips() const;
+	const AnimationClip& GetClip(int clipId) const;
+	const SDL_Rect& GetFrameRect(const AnimationClip& clip, int frame) const;
+	int GetFrame(const AnimationClip& clip, float time) const;
+};
@@ -3,12 +3,12 @@
 #include <SDL_image.h>
 
 AssetHandler::AssetHandler() {
-	Logger::trace("AssetHandler constructor called!");
+	LOG_TRACE(Assets, "AssetHandler constructor called!");
 }
 
 AssetHandler::~AssetHandler() {
 	ClearAssets();
-	Logger::trace("AssetHandler destructor called!");
+	LOG_TRACE(Assets, "AssetHandler destructor called!");
 }
 
 void AssetHandler::ClearAssets() {
@@ -16,18 +16,71 @@ void AssetHandler::ClearAssets() {
 		SDL_DestroyTexture(texture.second);
 	}
 	textures.clear();
+	texturePaths.clear();
+	atlas.Clear();
+	atlasPath.clear();
 }
 
-void AssetHandler::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath) {
+SDL_Texture* AssetHandler::LoadTexture(SDL_Renderer* renderer, const std::string& filePath) {
 	SDL_Surface* surface = IMG_Load(filePath.c_str());
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	SDL_FreeSurface(surface);
+	return texture;
+}
 
-	textures.emplace(assetId, texture);
+void AssetHandler::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath) {
+	textures.emplace(assetId, LoadTexture(renderer, filePath));
+	texturePaths.emplace(assetId, filePath);
 
-	Logger::debug("New Texture with id: \"" + assetId + "\" was added to the Asset Handler!");
+	LOG_DEBUG(Assets, "New Texture with id: \"{}\" was added to the Asset Handler!", assetId);
 }
 
 SDL_Texture* AssetHandler::GetTexture(const std::string& assetId) {
 	return textures[assetId];
+}
+
+void AssetHandler::ReloadTextures(SDL_Renderer* renderer) {
+	for (auto& [assetId, texture] : textures) {
+		SDL_DestroyTexture(texture);
+		texture = LoadTexture(renderer, texturePaths[assetId]);
+	}
+	// the same images give the same regions, so the sprites stay valid
+	if (!atlasPath.empty()) {
+		BuildAtlas(renderer, atlasPath);
+	}
+	LOG_INFO(Assets, "Reloaded {} textures and {} atlas pages", textures.size(), atlas.GetNumPages());
+}
+
+void AssetHandler::AddAtlasImages(const std::string& directory) {
+	atlas.AddImages(directory);
+}
+
+void AssetHandler::BuildAtlas(SDL_Renderer* renderer, const std::string& atlasPath) {
+	if (!atlas.HasImages()) {
+		return;
+	}
+	this->atlasPath = atlasPath;
+	// packing is the slow part, a saved atlas skips it
+	if (atlas.IsOutdated(atlasPath) || !atlas.Load(atlasPath)) {
+		if (!atlas.Pack()) {
+			return;
+		}
+		atlas.Save(atlasPath);
+	}
+	if (renderer) {
+		atlas.CreateTextures(renderer);
+	}
+}
+
+SDL_Texture* AssetHandler::GetAtlasPage(int page) const {
+	return atlas.GetPage(page);
+}
+
+SpriteComponent AssetHandler::CreateSprite(const std::string& assetId, int width, int height, int srcRectX, int srcRectY, int layer, int zIndex) const {
+	SpriteComponent sprite(assetId, width, height, srcRectX, srcRectY, layer, zIndex);
+	if (const TextureAtlas::Region* region = atlas.GetRegion(assetId)) {
+		sprite.atlasPage = region->page;
+		sprite.atlasRect = region->rect;
+	}
+	return sprite;
 }
\ No newline at end of file
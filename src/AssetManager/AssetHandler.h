@@ -3,10 +3,18 @@
 #include <vector>
 #include <SDL.h>
 #include <string>
+#include "TextureAtlas.h"
+#include "../Components/SpriteComponent.h"
 
 class AssetHandler {
 private:
 	std::map<std::string, SDL_Texture*> textures;
+	std::map<std::string, std::string> texturePaths; // [asset id] = file, for ReloadTextures()
+	// the sprite images, packed together so the sprites share few textures
+	TextureAtlas atlas;
+	std::string atlasPath;
+
+	static SDL_Texture* LoadTexture(SDL_Renderer* renderer, const std::string& filePath);
 
 public:
 	AssetHandler();
@@ -16,4 +24,15 @@ public:
 	
 	void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
 	SDL_Texture* GetTexture(const std::string & assetId);
+	// creates every texture and atlas page again from its file, after SDL_RENDER_DEVICE_RESET the old ones are dead
+	void ReloadTextures(SDL_Renderer* renderer);
+
+	// every png of the directory goes into the atlas, the file name without extension is the asset id
+	void AddAtlasImages(const std::string& directory);
+	// loads the atlas saved at atlasPath if it is up to date, or packs the images and saves them there
+	// without a renderer (headless) only the regions get loaded, CreateSprite() works but there are no pages to draw
+	void BuildAtlas(SDL_Renderer* renderer, const std::string& atlasPath);
+	SDL_Texture* GetAtlasPage(int page) const;
+	// a sprite which knows where its image is in the atlas, images outside the atlas come from GetTexture()
+	SpriteComponent CreateSprite(const std::string& assetId, int width, int height, int srcRectX = 0, int srcRectY = 0, int layer = 0, int zIndex = 0) const;
 };
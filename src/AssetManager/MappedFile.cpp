@@ -0,0 +1,96 @@
+#include "MappedFile.h"
+#include "../Logger/Logger.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& filePath) {
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		LOG_ERROR(Assets, "Error opening \"{}\" for mapping", filePath);
+		return nullptr;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		LOG_ERROR(Assets, "Error mapping \"{}\": the file is empty", filePath);
+		CloseHandle(file);
+		return nullptr;
+	}
+	// PAGE_WRITECOPY + FILE_MAP_COPY: writable, but the changes stay private
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+	if (!data) {
+		LOG_ERROR(Assets, "Error mapping \"{}\" (error {})", filePath, GetLastError());
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	std::unique_ptr<MappedFile> mappedFile(new MappedFile());
+	mappedFile->data = data;
+	mappedFile->size = static_cast<size_t>(fileSize.QuadPart);
+	mappedFile->fileHandle = file;
+	mappedFile->mappingHandle = mapping;
+	return mappedFile;
+}
+
+MappedFile::~MappedFile() {
+	UnmapViewOfFile(data);
+	CloseHandle(static_cast<HANDLE>(mappingHandle));
+	CloseHandle(static_cast<HANDLE>(fileHandle));
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& filePath) {
+	const int file = open(filePath.c_str(), O_RDONLY);
+	if (file == -1) {
+		LOG_ERROR(Assets, "Error opening \"{}\" for mapping", filePath);
+		return nullptr;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		LOG_ERROR(Assets, "Error mapping \"{}\": the file is empty", filePath);
+		close(file);
+		return nullptr;
+	}
+	// MAP_PRIVATE: writable, but the changes stay private
+	void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	// the mapping keeps the file alive
+	close(file);
+	if (data == MAP_FAILED) {
+		LOG_ERROR(Assets, "Error mapping \"{}\"", filePath);
+		return nullptr;
+	}
+
+	std::unique_ptr<MappedFile> mappedFile(new MappedFile());
+	mappedFile->data = data;
+	mappedFile->size = static_cast<size_t>(status.st_size);
+	return mappedFile;
+}
+
+MappedFile::~MappedFile() {
+	munmap(data, size);
+}
+
+#endif
+
+void* MappedFile::GetData() const {
+	return data;
+}
+
+size_t MappedFile::GetSize() const {
+	return size;
+}
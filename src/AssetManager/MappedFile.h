@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+// a file mapped into memory, the pages get read by the OS on first access instead of parsing the whole file up front
+// the mapping is copy on write: changes stay in memory (only the touched pages get copied) and never reach the file
+class MappedFile {
+private:
+	void* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+	MappedFile() = default;
+
+public:
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator =(const MappedFile&) = delete;
+
+	// nullptr if the file can't be opened or is empty
+	static std::unique_ptr<MappedFile> Open(const std::string& filePath);
+
+	void* GetData() const;
+	size_t GetSize() const;
+};
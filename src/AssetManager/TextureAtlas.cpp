@@ -0,0 +1,287 @@
+#include "TextureAtlas.h"
+#include "../Logger/Logger.h"
+#include <SDL_image.h>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+// our own copy of the packer, imgui_draw.cpp has another one which is static as well
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imgui/imstb_rectpack.h>
+
+TextureAtlas::~TextureAtlas() {
+	Clear();
+}
+
+void TextureAtlas::FreeSurfaces() {
+	for (SDL_Surface* surface : pageSurfaces) {
+		SDL_FreeSurface(surface);
+	}
+	pageSurfaces.clear();
+}
+
+void TextureAtlas::AddImage(const std::string& assetId, const std::string& filePath) {
+	images.push_back({ assetId, filePath });
+}
+
+void TextureAtlas::AddImages(const std::string& directory) {
+	std::error_code error;
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".png") {
+			files.push_back(entry.path());
+		}
+	}
+	if (error) {
+		LOG_ERROR(Assets, "Error reading the image directory \"{}\": {}", directory, error.message());
+	}
+	// the directory order differs between platforms, the packing should not
+	std::sort(files.begin(), files.end());
+	for (const std::filesystem::path& file : files) {
+		AddImage(file.stem().string(), file.generic_string());
+	}
+}
+
+bool TextureAtlas::HasImages() const {
+	return !images.empty();
+}
+
+bool TextureAtlas::Pack() {
+	FreeSurfaces();
+	regions.clear();
+
+	std::vector<SDL_Surface*> surfaces(images.size(), nullptr);
+	std::vector<stbrp_rect> rects;
+	for (size_t i = 0; i < images.size(); i++) {
+		SDL_Surface* surface = IMG_Load(images[i].filePath.c_str());
+		if (!surface) {
+			LOG_ERROR(Assets, "Error loading the image \"{}\": {}", images[i].filePath, IMG_GetError());
+			continue;
+		}
+		surfaces[i] = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(surface);
+		if (!surfaces[i]) {
+			continue;
+		}
+		// copied as they are, the page starts out transparent
+		SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+
+		stbrp_rect rect = {};
+		rect.id = static_cast<int>(i);
+		rect.w = static_cast<stbrp_coord>(std::min(surfaces[i]->w + PADDING, PAGE_SIZE + 1));
+		rect.h = static_cast<stbrp_coord>(std::min(surfaces[i]->h + PADDING, PAGE_SIZE + 1));
+		rects.push_back(rect);
+	}
+
+	// fills one page after the other with the images which didn't fit on the ones before
+	std::vector<stbrp_node> nodes(PAGE_SIZE);
+	std::vector<stbrp_rect> remaining;
+	while (!rects.empty()) {
+		stbrp_context context;
+		stbrp_init_target(&context, PAGE_SIZE, PAGE_SIZE, nodes.data(), static_cast<int>(nodes.size()));
+		stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()));
+
+		// the page is only as big as its images need
+		int pageWidth = 0;
+		int pageHeight = 0;
+		remaining.clear();
+		for (const stbrp_rect& rect : rects) {
+			if (rect.was_packed) {
+				pageWidth = std::max(pageWidth, rect.x + rect.w);
+				pageHeight = std::max(pageHeight, rect.y + rect.h);
+			}
+			else {
+				remaining.push_back(rect);
+			}
+		}
+		if (remaining.size() == rects.size()) {
+			for (const stbrp_rect& rect : rects) {
+				LOG_ERROR(Assets, "The image \"{}\" is too big for an atlas page of {} pixels", images[rect.id].filePath, PAGE_SIZE);
+			}
+			break;
+		}
+
+		SDL_Surface* page = SDL_CreateRGBSurfaceWithFormat(0, pageWidth, pageHeight, 32, SDL_PIXELFORMAT_RGBA32);
+		if (!page) {
+			LOG_ERROR(Assets, "Error creating an atlas page: {}", SDL_GetError());
+			break;
+		}
+		const int pageIndex = static_cast<int>(pageSurfaces.size());
+		for (const stbrp_rect& rect : rects) {
+			if (rect.was_packed) {
+				SDL_Rect target = { rect.x, rect.y, surfaces[rect.id]->w, surfaces[rect.id]->h };
+				SDL_BlitSurface(surfaces[rect.id], nullptr, page, &target);
+				regions[images[rect.id].assetId] = { pageIndex, target };
+			}
+		}
+		pageSurfaces.push_back(page);
+		rects.swap(remaining);
+	}
+
+	for (SDL_Surface* surface : surfaces) {
+		if (surface) {
+			SDL_FreeSurface(surface);
+		}
+	}
+
+	LOG_INFO(Assets, "Packed {} images into {} atlas pages", regions.size(), pageSurfaces.size());
+	return !regions.empty();
+}
+
+bool TextureAtlas::Save(const std::string& basePath) const {
+	const std::filesystem::path base(basePath);
+	std::error_code error;
+	if (base.has_parent_path()) {
+		std::filesystem::create_directories(base.parent_path(), error);
+	}
+
+	std::ofstream file(basePath + ".atlas");
+	if (!file) {
+		LOG_ERROR(Assets, "Error creating the atlas \"{}.atlas\"", basePath);
+		return false;
+	}
+	file << "# packed by TextureAtlas, remove it to pack the images again\n";
+	for (size_t i = 0; i < pageSurfaces.size(); i++) {
+		const std::string pageName = base.filename().string() + "-" + std::to_string(i) + ".png";
+		const std::string pagePath = (base.parent_path() / pageName).string();
+		if (IMG_SavePNG(pageSurfaces[i], pagePath.c_str()) != 0) {
+			LOG_ERROR(Assets, "Error saving the atlas page \"{}\": {}", pagePath, IMG_GetError());
+			return false;
+		}
+		file << "page " << pageName << "\n";
+	}
+	for (const Image& image : images) {
+		const auto region = regions.find(image.assetId);
+		if (region != regions.end()) {
+			const SDL_Rect& rect = region->second.rect;
+			file << "image " << image.assetId << " " << region->second.page << " " << rect.x << " " << rect.y << " " << rect.w << " " << rect.h << " " << image.filePath << "\n";
+		}
+	}
+	if (!file) {
+		LOG_ERROR(Assets, "Error writing the atlas \"{}.atlas\"", basePath);
+		return false;
+	}
+
+	LOG_INFO(Assets, "Saved the atlas \"{}.atlas\"", basePath);
+	return true;
+}
+
+bool TextureAtlas::IsOutdated(const std::string& basePath) const {
+	std::error_code error;
+	const std::filesystem::file_time_type atlasTime = std::filesystem::last_write_time(basePath + ".atlas", error);
+	if (error) {
+		return true;
+	}
+	for (const Image& image : images) {
+		// a missing image (a shipped game) keeps the atlas
+		const std::filesystem::file_time_type imageTime = std::filesystem::last_write_time(image.filePath, error);
+		if (!error && imageTime > atlasTime) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TextureAtlas::Load(const std::string& basePath) {
+	FreeSurfaces();
+	regions.clear();
+
+	std::ifstream file(basePath + ".atlas");
+	if (!file) {
+		return false;
+	}
+	const std::filesystem::path directory = std::filesystem::path(basePath).parent_path();
+	std::unordered_map<std::string, std::string> sourcePaths;
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream words(line);
+		std::string directive;
+		words >> directive;
+		if (directive == "page") {
+			std::string pageName;
+			words >> pageName;
+			const std::string pagePath = (directory / pageName).string();
+			SDL_Surface* page = IMG_Load(pagePath.c_str());
+			if (!page) {
+				LOG_ERROR(Assets, "Error loading the atlas page \"{}\": {}", pagePath, IMG_GetError());
+				FreeSurfaces();
+				return false;
+			}
+			pageSurfaces.push_back(page);
+		}
+		else if (directive == "image") {
+			std::string assetId;
+			Region region = { -1, { 0, 0, 0, 0 } };
+			words >> assetId >> region.page >> region.rect.x >> region.rect.y >> region.rect.w >> region.rect.h;
+			std::string sourcePath;
+			std::getline(words >> std::ws, sourcePath);
+			if (!words.fail()) {
+				regions[assetId] = region;
+				sourcePaths[assetId] = sourcePath;
+			}
+		}
+	}
+
+	// the atlas has to be packed from exactly the added images
+	bool isValid = sourcePaths.size() == images.size();
+	for (const Image& image : images) {
+		const auto sourcePath = sourcePaths.find(image.assetId);
+		isValid = isValid && sourcePath != sourcePaths.end() && sourcePath->second == image.filePath;
+	}
+	for (const auto& [assetId, region] : regions) {
+		isValid = isValid && region.page >= 0 && region.page < static_cast<int>(pageSurfaces.size());
+	}
+	if (!isValid) {
+		LOG_WARN(Assets, "The atlas \"{}.atlas\" was packed from other images", basePath);
+		FreeSurfaces();
+		regions.clear();
+		return false;
+	}
+
+	LOG_DEBUG(Assets, "Loaded the atlas \"{}.atlas\" ({} images, {} pages)", basePath, regions.size(), pageSurfaces.size());
+	return true;
+}
+
+bool TextureAtlas::CreateTextures(SDL_Renderer* renderer) {
+	for (SDL_Texture* page : pages) {
+		SDL_DestroyTexture(page);
+	}
+	pages.clear();
+	for (SDL_Surface* surface : pageSurfaces) {
+		SDL_Texture* page = SDL_CreateTextureFromSurface(renderer, surface);
+		if (!page) {
+			LOG_ERROR(Assets, "Error creating an atlas page texture: {}", SDL_GetError());
+			return false;
+		}
+		SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+		pages.push_back(page);
+	}
+	// the pixels live on the GPU now
+	FreeSurfaces();
+	return true;
+}
+
+void TextureAtlas::Clear() {
+	FreeSurfaces();
+	for (SDL_Texture* page : pages) {
+		SDL_DestroyTexture(page);
+	}
+	pages.clear();
+	regions.clear();
+	images.clear();
+}
+
+const TextureAtlas::Region* TextureAtlas::GetRegion(const std::string& assetId) const {
+	const auto region = regions.find(assetId);
+	return region != regions.end() ? &region->second : nullptr;
+}
+
+SDL_Texture* TextureAtlas::GetPage(int page) const {
+	return page >= 0 && page < static_cast<int>(pages.size()) ? pages[page] : nullptr;
+}
+
+int TextureAtlas::GetNumPages() const {
+	return static_cast<int>(pages.size());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <SDL.h>
+
+// packs many small images into a few big textures (pages), so sprites of different images
+// share a texture and the SpriteBatch draws them with one call
+// the packed pages can be saved with the position of every image, loading them skips the packing
+//
+// saved atlas (<basePath>.atlas, next to the pages <basePath>-<page>.png):
+//   page <file name>
+//   image <asset id> <page> <x> <y> <width> <height> <source path>
+class TextureAtlas {
+public:
+	static constexpr int PAGE_SIZE = 2048; // every renderer SDL supports has textures this big
+	static constexpr int PADDING = 1; // transparent pixels between the images, so filtering doesn't bleed into the neighbours
+
+	struct Region {
+		int page;
+		SDL_Rect rect; // in pixels of the page
+	};
+
+private:
+	struct Image {
+		std::string assetId;
+		std::string filePath;
+	};
+
+	std::vector<Image> images;
+	std::unordered_map<std::string, Region> regions;
+	std::vector<SDL_Surface*> pageSurfaces; // between Pack() / Load() and CreateTextures()
+	std::vector<SDL_Texture*> pages;
+
+	void FreeSurfaces();
+
+public:
+	TextureAtlas() = default;
+	~TextureAtlas();
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator =(const TextureAtlas&) = delete;
+
+	void AddImage(const std::string& assetId, const std::string& filePath);
+	// adds every png of the directory, the file name without extension is the asset id
+	void AddImages(const std::string& directory);
+	bool HasImages() const;
+
+	// packs the added images into pages, false if none could be loaded or packed
+	bool Pack();
+	// writes the packed pages and the regions, see above
+	bool Save(const std::string& basePath) const;
+	// true if the saved atlas is missing or older than one of the images
+	bool IsOutdated(const std::string& basePath) const;
+	// reads a saved atlas instead of packing, false if it is missing or was packed from other images
+	bool Load(const std::string& basePath);
+	// uploads the packed or loaded pages
+	bool CreateTextures(SDL_Renderer* renderer);
+	void Clear();
+
+	// nullptr if the image is not in the atlas
+	const Region* GetRegion(const std::string& assetId) const;
+	SDL_Texture* GetPage(int page) const;
+	int GetNumPages() const;
+};
@@ -0,0 +1,108 @@
+#include "ECSBenchmark.h"
+#include <chrono>
+#include <string>
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Systems/MovementSystem.h"
+
+namespace {
+	// some components only a part of the entities have, so the archetype storage has more than one archetype
+	struct HealthComponent {
+		int health = 100;
+	};
+
+	struct TagComponent {
+		int tag = 0;
+	};
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void RunStorageMode(StorageMode storageMode, const std::string& name, int numEntities, int numFrames, JobSystem& jobSystem) {
+		Registry registry(storageMode);
+		registry.SetJobSystem(&jobSystem);
+		registry.AddSystem<MovementSystem>();
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<Entity> entities;
+		entities.reserve(numEntities);
+		for (int i = 0; i < numEntities; i++) {
+			Entity entity = registry.CreateEntity();
+			entity.AddComponent<TransformComponent>(glm::vec2(i, i), glm::vec2(1.0, 1.0), 0.0);
+			entity.AddComponent<RigidBodyComponent>(glm::vec2(10.0, 5.0));
+			if (i % 3 == 0) {
+				entity.AddComponent<HealthComponent>();
+			}
+			if (i % 5 == 0) {
+				entity.AddComponent<TagComponent>();
+			}
+			entities.push_back(entity);
+		}
+		registry.Update();
+		const double createTime = MillisecondsSince(start);
+
+		// the same with the bulk functions in a second registry
+		double bulkCreateTime;
+		{
+			Registry bulkRegistry(storageMode);
+			bulkRegistry.AddSystem<MovementSystem>();
+			std::vector<TransformComponent> transforms;
+			std::vector<RigidBodyComponent> rigidBodies(numEntities, RigidBodyComponent(glm::vec2(10.0, 5.0)));
+			transforms.reserve(numEntities);
+			for (int i = 0; i < numEntities; i++) {
+				transforms.emplace_back(glm::vec2(i, i), glm::vec2(1.0, 1.0), 0.0);
+			}
+
+			start = std::chrono::steady_clock::now();
+			std::vector<Entity> bulkEntities = bulkRegistry.CreateEntities(numEntities);
+			bulkRegistry.AddComponents<TransformComponent>(bulkEntities, transforms);
+			bulkRegistry.AddComponents<RigidBodyComponent>(bulkEntities, rigidBodies);
+			bulkRegistry.Update();
+			bulkCreateTime = MillisecondsSince(start);
+		}
+
+		MovementSystem& movementSystem = registry.GetSystem<MovementSystem>();
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < numFrames; frame++) {
+			movementSystem.Update(1.0 / 60.0);
+		}
+		const double iterateTime = MillisecondsSince(start);
+
+		movementSystem.SetParallel(true);
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < numFrames; frame++) {
+			movementSystem.Update(1.0 / 60.0);
+		}
+		const double parallelIterateTime = MillisecondsSince(start);
+		movementSystem.SetParallel(false);
+
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < numFrames; frame++) {
+			for (int i = 0; i < numEntities; i += 2) {
+				entities[i].RemoveComponent<HealthComponent>();
+				entities[i].AddComponent<HealthComponent>();
+			}
+			registry.Update();
+		}
+		const double addRemoveTime = MillisecondsSince(start);
+
+		LOG_INFO(Core,
+			"{}: create {:.3f} ms, bulk create {:.3f} ms, iterate {:.3f} ms/frame, parallel iterate {:.3f} ms/frame, add/remove {:.3f} ms/frame",
+			name, createTime, bulkCreateTime, iterateTime / numFrames, parallelIterateTime / numFrames, addRemoveTime / numFrames
+		);
+	}
+}
+
+void Benchmark::RunECSBenchmark(int numEntities, int numFrames) {
+	Logger::set_level(Logger::level::info);
+	LOG_INFO(Core, "ECS benchmark with {} entities and {} frames", numEntities, numFrames);
+
+	JobSystem jobSystem;
+	LOG_INFO(Core, "Parallel iteration uses {} workers", jobSystem.GetNumWorkers());
+
+	RunStorageMode(StorageMode::Pools, "Pools", numEntities, numFrames, jobSystem);
+	RunStorageMode(StorageMode::Archetypes, "Archetypes", numEntities, numFrames, jobSystem);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// compares the storage modes of the Registry
+namespace Benchmark {
+	// iteration heavy: moves every entity numFrames times
+	// add/remove heavy: removes and adds a component of every second entity numFrames times
+	void RunECSBenchmark(int numEntities = 100000, int numFrames = 100);
+}
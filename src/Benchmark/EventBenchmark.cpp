@@ -0,0 +1,69 @@
+#include "EventBenchmark.h"
+#include <chrono>
+#include <string>
+#include "../EventBus/EventBus.h"
+#include "../Logger/Logger.h"
+
+namespace {
+	struct DamageEvent {
+		int entityId;
+		int damage;
+
+		DamageEvent(int entityId, int damage) : entityId(entityId), damage(damage) {
+		}
+	};
+
+	// one subscriber per event and one per batch
+	struct DamageCounter {
+		long long totalDamage = 0;
+
+		void OnDamage(const DamageEvent& event) {
+			totalDamage += event.damage;
+		}
+
+		void OnDamageBatch(Span<const DamageEvent> events) {
+			for (const DamageEvent& event : events) {
+				totalDamage += event.damage;
+			}
+		}
+	};
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void Benchmark::RunEventBenchmark(int numEvents) {
+	Logger::set_level(Logger::level::info);
+	LOG_INFO(Core, "Event benchmark with {} events", numEvents);
+
+	EventBus eventBus;
+	DamageCounter counter;
+	DamageCounter batchCounter;
+	eventBus.Subscribe<DamageEvent, DamageCounter, &DamageCounter::OnDamage>(&counter);
+	eventBus.SubscribeBatch<DamageEvent, DamageCounter, &DamageCounter::OnDamageBatch>(&batchCounter);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < numEvents; i++) {
+		eventBus.Emit<DamageEvent>(i, 1);
+	}
+	const double immediateTime = MillisecondsSince(start);
+
+	// 60 frames, the queues keep their memory after the first one
+	const int numFrames = 60;
+	start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < numFrames; frame++) {
+		for (int i = frame * numEvents / numFrames; i < (frame + 1) * numEvents / numFrames; i++) {
+			eventBus.Enqueue<DamageEvent>(i, 1);
+		}
+		eventBus.Dispatch();
+	}
+	const double deferredTime = MillisecondsSince(start);
+
+	const bool isCorrect = counter.totalDamage == 2LL * numEvents && batchCounter.totalDamage == 2LL * numEvents;
+	LOG_INFO(Core,
+		"Events: immediate {:.3f} ms ({:.1f} M events/s), deferred {:.3f} ms ({:.1f} M events/s){}",
+		immediateTime, numEvents / immediateTime / 1000.0, deferredTime, numEvents / deferredTime / 1000.0,
+		isCorrect ? "" : ", WRONG number of received events"
+	);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// throughput of the EventBus
+namespace Benchmark {
+	// sends numEvents events to two subscribers, immediate and deferred
+	void RunEventBenchmark(int numEvents = 1000000);
+}
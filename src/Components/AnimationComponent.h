@@ -0,0 +1,22 @@
+#pragma once
+
+// plays a clip of the AnimationLibrary on the SpriteComponent of the entity, see AnimationSystem
+struct AnimationComponent {
+	int clipId; // -1 for no animation
+	float time; // in seconds since the clip started
+	int frame; // in the clip, set by the AnimationSystem
+
+	AnimationComponent(int clipId = -1, float time = 0.0f) {
+		this->clipId = clipId;
+		this->time = time;
+		this->frame = 0;
+	}
+
+	// starts the clip from the beginning, unless it is playing already
+	void Play(int clipId) {
+		if (this->clipId != clipId) {
+			this->clipId = clipId;
+			this->time = 0.0f;
+		}
+	}
+};
\ No newline at end of file
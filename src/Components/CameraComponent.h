@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <SDL.h>
+#include "../ECS/ECS.h"
+
+// view into the world, the RenderingSystem draws what the camera sees
+// position is the top left corner in world coordinates, the viewport (in pixels)
+// shows viewportWidth / zoom x viewportHeight / zoom of the world
+// the CameraSystem moves the camera to its target and keeps it inside the bounds
+struct CameraComponent {
+	glm::vec2 position;
+	glm::vec2 previousPosition; // before the last simulation step, the renderer draws between the two
+	int viewportWidth;
+	int viewportHeight;
+	float zoom; // 2 = everything twice as big
+	Entity target;
+	bool hasTarget;
+	float followSpeed; // how fast the camera catches up with the target, 0 = right away
+	SDL_Rect bounds; // in world coordinates, 0 width or height = no limit on that axis
+
+	CameraComponent(int viewportWidth = 0, int viewportHeight = 0, float zoom = 1.0f, SDL_Rect bounds = { 0, 0, 0, 0 }) : target(Entity(0)) {
+		this->position = glm::vec2(0, 0);
+		this->previousPosition = this->position;
+		this->viewportWidth = viewportWidth;
+		this->viewportHeight = viewportHeight;
+		this->zoom = zoom;
+		this->hasTarget = false;
+		this->followSpeed = 0.0f;
+		this->bounds = bounds;
+	}
+
+	void Follow(Entity target, float followSpeed = 0.0f) {
+		this->target = target;
+		this->hasTarget = true;
+		this->followSpeed = followSpeed;
+	}
+
+	// size of the visible part of the world
+	glm::vec2 GetViewSize() const {
+		const float safeZoom = zoom > 0.0f ? zoom : 1.0f;
+		return glm::vec2(viewportWidth / safeZoom, viewportHeight / safeZoom);
+	}
+
+	SDL_FRect GetWorldRect() const {
+		const glm::vec2 viewSize = GetViewSize();
+		return { position.x, position.y, viewSize.x, viewSize.y };
+	}
+};
\ No newline at end of file
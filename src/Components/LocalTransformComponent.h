@@ -0,0 +1,15 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// transform relative to the parent (see ParentComponent), rotation in degrees like TransformComponent
+struct LocalTransformComponent {
+	glm::vec2 position;
+	glm::vec2 scale;
+	double rotation;
+
+	LocalTransformComponent(glm::vec2 position = glm::vec2(0, 0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0) {
+		this->position = position;
+		this->scale = scale;
+		this->rotation = rotation;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+
+// attaches the entity to another entity, the HierarchySystem then computes the TransformComponent
+// of the entity from the (world) TransformComponent of the parent and its LocalTransformComponent
+struct ParentComponent {
+	Entity parent;
+
+	ParentComponent(Entity parent = Entity(0)) : parent(parent) {
+	}
+};
\ No newline at end of file
@@ -4,12 +4,21 @@ struct SpriteComponent {
 	std::string assetId;
 	int width;
 	int height;
-	SDL_Rect srcRect;
+	SDL_Rect srcRect; // part of the image
+	int layer; // the layers get drawn from 0 to 255 (e.g. ground, units, air)
+	int zIndex; // order inside the layer, -32768 to 32767, the entity order decides between equal ones
+	// where the image is in the texture atlas, -1 if it is a texture of its own (see AssetHandler::CreateSprite())
+	int atlasPage;
+	SDL_Rect atlasRect;
 
-	SpriteComponent(const std::string& assetId = "", int width = 1, int height = 1, int srcRectX = 0, int srcRectY = 0) {
+	SpriteComponent(const std::string& assetId = "", int width = 1, int height = 1, int srcRectX = 0, int srcRectY = 0, int layer = 0, int zIndex = 0) {
 		this->assetId = assetId;
 		this->width = width;
 		this->height = height;
 		this->srcRect = { srcRectX, srcRectY, width, height };
+		this->layer = layer;
+		this->zIndex = zIndex;
+		this->atlasPage = -1;
+		this->atlasRect = { 0, 0, 0, 0 };
 	}
 };
\ No newline at end of file
@@ -5,10 +5,21 @@ struct TransformComponent {
 	glm::vec2 position;
 	glm::vec2 scale;
 	double rotation;
+	// the transform before the last simulation step, the renderer draws between it and the current one
+	// (see InterpolationSystem), set them as well to jump somewhere without sliding there
+	glm::vec2 previousPosition;
+	double previousRotation;
 
 	TransformComponent(glm::vec2 position = glm::vec2(0, 0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0) {
 		this->position = position;
 		this->scale = scale;
 		this->rotation = rotation;
+		this->previousPosition = position;
+		this->previousRotation = rotation;
+	}
+
+	// alpha = how far the time got from the previous step to the current one (0 to 1)
+	TransformComponent Interpolate(float alpha) const {
+		return TransformComponent(glm::mix(previousPosition, position, alpha), scale, previousRotation + (rotation - previousRotation) * alpha);
 	}
 };
\ No newline at end of file
@@ -8,7 +8,19 @@ int IComponent::nextId = 0;
 ///////////////////
 
 int Entity::GetId() const{
-	return id;
+	return static_cast<int>(handle & ENTITY_INDEX_MASK);
+}
+
+int Entity::GetGeneration() const {
+	return static_cast<int>(handle >> ENTITY_INDEX_BITS);
+}
+
+uint32_t Entity::GetHandle() const {
+	return handle;
+}
+
+void Entity::Kill() {
+	registry->KillEntity(*this);
 }
 
 
@@ -17,61 +29,750 @@ int Entity::GetId() const{
 ///////////////////
 
 void System::AddEntityToSystem(Entity entity) {
+	const int entityId = entity.GetId();
+	if (entityId >= entityIndices.size()) {
+		entityIndices.resize(entityId + 1, -1);
+	}
+	if (entityIndices[entityId] != -1) {
+		return;
+	}
+	entityIndices[entityId] = static_cast<int>(entities.size());
 	entities.push_back(entity);
+	membershipVersion++;
 }
 
 void System::RemoveEntityFromSystem(Entity entity) {
-	entities.erase(std::remove_if(entities.begin(), entities.end(), [&entity](Entity other) {
-		return entity == other;
-	}), entities.end());
+	if (!HasEntity(entity)) {
+		return;
+	}
+	const int entityId = entity.GetId();
+	const int index = entityIndices[entityId];
+
+	const Entity last = entities.back();
+	entities[index] = last;
+	entityIndices[last.GetId()] = index;
+
+	entities.pop_back();
+	entityIndices[entityId] = -1;
+	membershipVersion++;
 }
 
-std::vector<Entity> System::GetSystemEnties() const {
+bool System::HasEntity(Entity entity) const {
+	const int entityId = entity.GetId();
+	return entityId < entityIndices.size() && entityIndices[entityId] != -1;
+}
+
+Span<const Entity> System::GetSystemEnties() const {
 	return entities;
 }
 
+uint32_t System::GetMembershipVersion() const {
+	return membershipVersion;
+}
+
 const Signature& System::GetComponentSignature() const {
 	return componentSignature;
 }
 
+const Signature& System::GetReadComponents() const {
+	return readComponents;
+}
+
+const Signature& System::GetWriteComponents() const {
+	return writeComponents;
+}
+
+bool System::ConflictsWith(const System& other) const {
+	return (writeComponents & (other.readComponents | other.writeComponents)).any()
+		|| (other.writeComponents & (readComponents | writeComponents)).any();
+}
+
+void System::SetParallel(bool parallel) {
+	isParallel = parallel;
+}
+
+bool System::IsParallel() const {
+	return isParallel;
+}
+
+
+///////////////////
+//// CommandBuffer
+///////////////////
+
+CommandBuffer::~CommandBuffer() {
+	Reset();
+}
+
+void* CommandBuffer::Allocate(size_t size, size_t alignment) {
+	while (true) {
+		if (currentBlock == blocks.size()) {
+			// bigger objects get a block for themselves
+			const size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+			blocks.push_back({ std::make_unique<std::byte[]>(blockSize), blockSize, 0 });
+		}
+		Block& block = blocks[currentBlock];
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block.memory.get()) + block.used;
+		const size_t padding = (alignment - address % alignment) % alignment;
+		if (block.used + padding + size <= block.size) {
+			block.used += padding + size;
+			return reinterpret_cast<void*>(address + padding);
+		}
+		currentBlock++;
+	}
+}
+
+CommandBuffer::Command* CommandBuffer::AddCommand(CommandType type) {
+	Command* command = new (Allocate(sizeof(Command), alignof(Command))) Command();
+	command->type = type;
+	command->sortKey = sortKey;
+	command->jobKey = jobKey;
+	command->sequence = nextSequence++;
+	command->buffer = this;
+	commands.push_back(command);
+	return command;
+}
+
+void CommandBuffer::Reset() {
+	// components which were played back are moved-from, but still need their destructor
+	for (Command* command : commands) {
+		if (command->component) {
+			command->destroyComponent(command->component);
+		}
+	}
+	commands.clear();
+	createdEntities.clear();
+	for (Block& block : blocks) {
+		block.used = 0;
+	}
+	currentBlock = 0;
+	sortKey = 0;
+	jobKey = 0;
+	nextSequence = 0;
+}
+
+void CommandBuffer::SetSortKey(uint32_t key) {
+	sortKey = key;
+}
+
+DeferredEntity CommandBuffer::CreateEntity() {
+	Command* command = AddCommand(CommandType::CreateEntity);
+	command->deferredIndex = static_cast<int>(createdEntities.size());
+	createdEntities.push_back(Entity(0));
+	return { command->deferredIndex, sortKey };
+}
+
+void CommandBuffer::KillEntity(Entity entity) {
+	Command* command = AddCommand(CommandType::KillEntity);
+	command->entity = entity;
+}
+
+bool CommandBuffer::IsEmpty() const {
+	return commands.empty();
+}
+
+///////////////////
+//// Scheduler
+///////////////////
+
+void Scheduler::Build() {
+	levels.clear();
+
+	// [index in systems] = level, one level after the latest conflicting system scheduled before it
+	std::vector<int> systemLevels(systems.size(), 0);
+	for (size_t i = 0; i < systems.size(); i++) {
+		for (size_t j = 0; j < i; j++) {
+			if (systems[i].system->ConflictsWith(*systems[j].system)) {
+				systemLevels[i] = std::max(systemLevels[i], systemLevels[j] + 1);
+			}
+		}
+		if (systemLevels[i] >= levels.size()) {
+			levels.resize(systemLevels[i] + 1);
+		}
+		levels[systemLevels[i]].push_back(static_cast<int>(i));
+	}
+	isDirty = false;
+
+	LOG_DEBUG(ECS, "Scheduler execution order:\n{}", GetExecutionOrder());
+}
+
+void Scheduler::Remove(System* system) {
+	systems.erase(std::remove_if(systems.begin(), systems.end(), [system](const ScheduledSystem& scheduledSystem) {
+		return scheduledSystem.system == system;
+	}), systems.end());
+	isDirty = true;
+}
+
+void Scheduler::RunSystem(int index, double deltaTime) {
+	// the commands the system records get played back in the order of the systems
+	CommandBuffer& commandBuffer = systems[index].system->registry->GetCommandBuffer();
+	const uint64_t previousKey = commandBuffer.jobKey;
+	commandBuffer.jobKey = static_cast<uint64_t>(index + 1) << 48;
+	systems[index].update(systems[index].system, deltaTime);
+	commandBuffer.jobKey = previousKey;
+}
+
+void Scheduler::Run(double deltaTime, JobSystem* jobSystem) {
+	if (isDirty) {
+		Build();
+	}
+
+	for (const auto& level : levels) {
+		if (!jobSystem || level.size() == 1) {
+			for (int index : level) {
+				RunSystem(index, deltaTime);
+			}
+			continue;
+		}
+		jobSystem->ParallelFor(static_cast<int>(level.size()), 1, [&](int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				RunSystem(level[i], deltaTime);
+			}
+		});
+	}
+}
+
+std::string Scheduler::GetExecutionOrder() {
+	if (isDirty) {
+		Build();
+	}
+
+	std::string executionOrder;
+	for (size_t level = 0; level < levels.size(); level++) {
+		executionOrder += "level " + std::to_string(level) + ":";
+		for (int index : levels[level]) {
+			executionOrder += " " + systems[index].name;
+		}
+		executionOrder += "\n";
+	}
+	return executionOrder;
+}
+
 Entity Registry::CreateEntity() {
 	int entityId;
-	entityId = numEntities++; 
-	Entity entity(entityId);
+	if (!freeIds.empty()) {
+		entityId = freeIds.front();
+		freeIds.pop_front();
+	}
+	else {
+		// another id would spill into the generation bits and alias the handles of other entities
+		if (numEntities >= MAX_ENTITIES) {
+			LOG_CRITICAL(ECS, "Too many entities, the maximum is {}", MAX_ENTITIES);
+			Logger::Flush();
+			std::abort();
+		}
+		entityId = numEntities++;
+	}
+	
+	ReserveEntityIds(entityId + 1);
+
+	Entity entity(entityId, entityGenerations[entityId]);
 	entity.registry = this;
-	entitesToBeAdded.insert(entity);
+	entitesToBeAdded.push_back(entity);
+
+	LOG_DEBUG(ECS, "Entity created with id = {} generation = {}", entityId, entity.GetGeneration());
 
-	if (entityId >= entityComponentSignatures.size()) {
-		entityComponentSignatures.resize(entityId + 1);
+	return entity;
+}
+
+std::vector<Entity> Registry::CreateEntities(int count) {
+	std::vector<Entity> entities;
+	entities.reserve(count);
+
+	const int numReusedIds = std::min(count, static_cast<int>(freeIds.size()));
+	const int numNewIds = count - numReusedIds;
+	if (numEntities + numNewIds > MAX_ENTITIES) {
+		LOG_CRITICAL(ECS, "Too many entities, the maximum is {}", MAX_ENTITIES);
+		Logger::Flush();
+		std::abort();
 	}
+	ReserveEntityIds(numEntities + numNewIds);
+	entitesToBeAdded.reserve(entitesToBeAdded.size() + count);
 
-	Logger::debug("Entity created with id = " + std::to_string(entityId));
+	for (int i = 0; i < count; i++) {
+		int entityId;
+		if (i < numReusedIds) {
+			entityId = freeIds.front();
+			freeIds.pop_front();
+		}
+		else {
+			entityId = numEntities++;
+		}
 
-	return entity;
+		Entity entity(entityId, entityGenerations[entityId]);
+		entity.registry = this;
+		entities.push_back(entity);
+		entitesToBeAdded.push_back(entity);
+	}
+
+	LOG_DEBUG(ECS, "{} entities created", count);
+
+	return entities;
+}
+
+void Registry::ReserveEntityIds(int numIds) {
+	if (numIds <= entityComponentSignatures.size()) {
+		return;
+	}
+	entityComponentSignatures.resize(numIds);
+	entityGenerations.resize(numIds, 0);
+	systemEntitySignatures.resize(numIds);
+	signatureChangeQueued.resize(numIds, false);
+	entitiesInSystems.resize(numIds, false);
+}
+
+void Registry::KillEntity(Entity entity) {
+	entitesToBeRemoved.insert(entity);
+}
+
+bool Registry::IsAlive(Entity entity) const {
+	const int entityId = entity.GetId();
+	return entityId < numEntities && entityGenerations[entityId] == entity.GetGeneration();
+}
+
+void Registry::QueueSignatureChange(Entity entity) {
+	const int entityId = entity.GetId();
+	if (signatureChangeQueued[entityId]) {
+		return;
+	}
+	signatureChangeQueued[entityId] = true;
+	entity.registry = this;
+	entitiesWithChangedSignature.push_back(entity);
+}
+
+void Registry::ApplySignatureChange(Entity entity, const Signature& oldSignature, const Signature& newSignature) {
+	const Signature changedComponents = oldSignature ^ newSignature;
+	if (changedComponents.none()) {
+		return;
+	}
+
+	for (int componentId = 0; componentId < MAX_COMPONENTS; componentId++) {
+		if (!changedComponents.test(componentId)) {
+			continue;
+		}
+		// a system which requires more than one changed component gets checked more than once,
+		// but adding/removing an entity twice does nothing
+		for (System* system : systemsByComponent[componentId]) {
+			const auto& systemComponentSignature = system->GetComponentSignature();
+
+			const bool wasInterested = (oldSignature & systemComponentSignature) == systemComponentSignature;
+			const bool isInterested = (newSignature & systemComponentSignature) == systemComponentSignature;
+
+			if (isInterested && !wasInterested) {
+				system->AddEntityToSystem(entity);
+			}
+			else if (!isInterested && wasInterested) {
+				system->RemoveEntityFromSystem(entity);
+			}
+		}
+	}
+}
+
+void Registry::AddSystemToIndex(System* system) {
+	const Signature& systemComponentSignature = system->GetComponentSignature();
+	if (systemComponentSignature.none()) {
+		systemsWithoutComponents.push_back(system);
+	}
+	for (int componentId = 0; componentId < MAX_COMPONENTS; componentId++) {
+		if (systemComponentSignature.test(componentId)) {
+			systemsByComponent[componentId].push_back(system);
+		}
+	}
+
+	// entities which already are in the other systems, newer ones get added in the next Update()
+	for (int entityId = 0; entityId < numEntities; entityId++) {
+		if (entitiesInSystems[entityId] && (systemEntitySignatures[entityId] & systemComponentSignature) == systemComponentSignature) {
+			Entity entity(entityId, entityGenerations[entityId]);
+			entity.registry = this;
+			system->AddEntityToSystem(entity);
+		}
+	}
+}
+
+void Registry::RemoveSystemFromIndex(System* system) {
+	auto removeSystem = [system](std::vector<System*>& list) {
+		list.erase(std::remove(list.begin(), list.end(), system), list.end());
+	};
+	removeSystem(systemsWithoutComponents);
+	for (auto& list : systemsByComponent) {
+		removeSystem(list);
+	}
 }
 
 void Registry::AddEntityToSystems(Entity entity) {
 	const auto entityId = entity.GetId();
 
-	const auto& entityComponentSignature = entityComponentSignatures[entityId];
-	
-	// Loop all the systems
-	for (auto& system : systems) {
-		const auto& systemComponentSignature = system.second->GetComponentSignature();
+	for (System* system : systemsWithoutComponents) {
+		system->AddEntityToSystem(entity);
+	}
+	// the systems know the entity without any component until now
+	ApplySignatureChange(entity, Signature(), entityComponentSignatures[entityId]);
+
+	systemEntitySignatures[entityId] = entityComponentSignatures[entityId];
+	entitiesInSystems[entityId] = true;
+}
+
+void Registry::RemoveEntityFromSystems(Entity entity) {
+	const auto entityId = entity.GetId();
+
+	for (System* system : systemsWithoutComponents) {
+		system->RemoveEntityFromSystem(entity);
+	}
+	ApplySignatureChange(entity, systemEntitySignatures[entityId], Signature());
+
+	systemEntitySignatures[entityId].reset();
+	entitiesInSystems[entityId] = false;
+}
 
-		bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
+void Registry::PlaybackCommandBuffers() {
+	commandsToPlayback.clear();
+	for (auto& commandBuffer : commandBuffers) {
+		commandsToPlayback.insert(commandsToPlayback.end(), commandBuffer->commands.begin(), commandBuffer->commands.end());
+	}
+	if (commandsToPlayback.empty()) {
+		return;
+	}
+
+	// the commands of one job come from one thread in the order of their sequence, no matter which worker ran the job
+	// only commands recorded outside of the systems by different threads (main and simulation thread) need the buffer order
+	std::sort(commandsToPlayback.begin(), commandsToPlayback.end(), [](const CommandBuffer::Command* a, const CommandBuffer::Command* b) {
+		if (a->sortKey != b->sortKey) {
+			return a->sortKey < b->sortKey;
+		}
+		if (a->jobKey != b->jobKey) {
+			return a->jobKey < b->jobKey;
+		}
+		if (a->buffer != b->buffer) {
+			return a->buffer->index < b->buffer->index;
+		}
+		return a->sequence < b->sequence;
+	});
 
-		if (isInterested) {
-			system.second->AddEntityToSystem(entity);
+	for (CommandBuffer::Command* command : commandsToPlayback) {
+		Entity entity = command->deferredIndex == -1 ? command->entity : command->buffer->createdEntities[command->deferredIndex];
+		entity.registry = this;
+
+		switch (command->type) {
+			case CommandBuffer::CommandType::CreateEntity:
+				command->buffer->createdEntities[command->deferredIndex] = CreateEntity();
+				break;
+			case CommandBuffer::CommandType::KillEntity:
+				KillEntity(entity);
+				break;
+			case CommandBuffer::CommandType::AddComponent:
+				if (IsAlive(entity)) {
+					command->addComponent(*this, entity, command->component);
+				}
+				break;
+			case CommandBuffer::CommandType::RemoveComponent:
+				if (IsAlive(entity)) {
+					command->removeComponent(*this, entity);
+				}
+				break;
 		}
 	}
+
+	for (auto& commandBuffer : commandBuffers) {
+		commandBuffer->Reset();
+	}
 }
 
 void Registry::Update() {
+	PlaybackCommandBuffers();
+
 	for (auto entity : entitesToBeAdded) {
 		AddEntityToSystems(entity);
 	}
 	entitesToBeAdded.clear();
 
+	// only the systems which require one of the changed components are touched
+	for (auto entity : entitiesWithChangedSignature) {
+		const int entityId = entity.GetId();
+		signatureChangeQueued[entityId] = false;
+		if (!entitiesInSystems[entityId]) {
+			continue;
+		}
+		ApplySignatureChange(entity, systemEntitySignatures[entityId], entityComponentSignatures[entityId]);
+		systemEntitySignatures[entityId] = entityComponentSignatures[entityId];
+	}
+	entitiesWithChangedSignature.clear();
+
+	// one pass over the killed entities: leave the systems, release the components and free the id
+	for (auto entity : entitesToBeRemoved) {
+		// killed twice or the handle was already stale
+		if (!IsAlive(entity)) {
+			continue;
+		}
+		const int entityId = entity.GetId();
+
+		RemoveEntityFromSystems(entity);
+
+		Signature& signature = entityComponentSignatures[entityId];
+		if (storageMode == StorageMode::Archetypes) {
+			archetypes.RemoveEntity(entityId);
+		}
+		else {
+			for (int componentId = 0; componentId < componentPools.size(); componentId++) {
+				if (signature.test(componentId) && componentPools[componentId]) {
+					componentPools[componentId]->RemoveEntityFromPool(entityId);
+				}
+			}
+		}
+		signature.reset();
+
+		entityGenerations[entityId] = (entityGenerations[entityId] + 1) & ENTITY_GENERATION_MASK;
+		freeIds.push_back(entityId);
+
+		LOG_DEBUG(ECS, "Entity killed with id = {}", entityId);
+	}
+	entitesToBeRemoved.clear();
+}
+
+StorageMode Registry::GetStorageMode() const {
+	return storageMode;
+}
+
+void Registry::SetJobSystem(JobSystem* jobSystem) {
+	this->jobSystem = jobSystem;
+
+	// one buffer per worker and one for the threads outside the job system, created now so the workers never resize the list
+	const size_t numBuffers = jobSystem ? jobSystem->GetNumWorkers() + 1 : 1;
+	while (commandBuffers.size() < numBuffers) {
+		commandBuffers.push_back(std::make_unique<CommandBuffer>());
+		commandBuffers.back()->index = static_cast<uint32_t>(commandBuffers.size()) - 1;
+	}
+}
+
+JobSystem* Registry::GetJobSystem() const {
+	return jobSystem;
+}
+
+CommandBuffer& Registry::GetCommandBuffer() {
+	return *commandBuffers[jobSystem ? jobSystem->GetQueueIndex() : 0];
+}
+
+void Registry::RunSystems(double deltaTime) {
+	scheduler.Run(deltaTime, jobSystem);
+}
+
+Scheduler& Registry::GetScheduler() {
+	return scheduler;
+}
+
+
+///////////////////
+//// Archetype
+///////////////////
+
+Archetype::Archetype(const Signature& signature, const std::vector<ComponentInfo>& componentInfos) : signature(signature) {
+	std::fill(std::begin(columns), std::end(columns), -1);
+
+	size_t bytesPerEntity = sizeof(int);
+	for (int componentId = 0; componentId < MAX_COMPONENTS; componentId++) {
+		if (!signature.test(componentId)) {
+			continue;
+		}
+		columns[componentId] = static_cast<int>(componentIds.size());
+		componentIds.push_back(componentId);
+		columnInfos.push_back(componentInfos[componentId]);
+		bytesPerEntity += componentInfos[componentId].size + sizeof(uint32_t);
+	}
+	columnOffsets.resize(componentIds.size());
+	stampOffsets.resize(componentIds.size());
+
+	// shrink the capacity until the entity ids and all the aligned columns fit into one chunk
+	const size_t chunkBytes = sizeof(Chunk::data);
+	chunkCapacity = static_cast<int>(chunkBytes / bytesPerEntity);
+	while (chunkCapacity > 0 && Layout() > chunkBytes) {
+		chunkCapacity--;
+	}
+	// every component fits on its own (RegisterComponent()), but not all of them together
+	if (chunkCapacity == 0) {
+		LOG_CRITICAL(ECS, "The components of an archetype need {} bytes per entity, more than a chunk has", bytesPerEntity);
+		Logger::Flush();
+		std::abort();
+	}
+	// the offsets of the capacity which fits
+	Layout();
+}
+
+size_t Archetype::Layout() {
+	size_t offset = chunkCapacity * sizeof(int);
+	for (size_t column = 0; column < columnInfos.size(); column++) {
+		const size_t alignment = columnInfos[column].alignment;
+		offset = (offset + alignment - 1) / alignment * alignment;
+		columnOffsets[column] = offset;
+		offset += chunkCapacity * columnInfos[column].size;
+		offset = (offset + alignof(uint32_t) - 1) / alignof(uint32_t) * alignof(uint32_t);
+		stampOffsets[column] = offset;
+		offset += chunkCapacity * sizeof(uint32_t);
+	}
+	return offset;
+}
+
+Archetype::~Archetype() {
+	for (auto& chunk : chunks) {
+		for (int row = 0; row < chunk->count; row++) {
+			for (size_t column = 0; column < columnInfos.size(); column++) {
+				columnInfos[column].destroy(GetComponent(*chunk, static_cast<int>(column), row));
+			}
+		}
+	}
+}
+
+void Archetype::AllocateRow(int entityId, int& chunkIndex, int& row) {
+	if (chunks.empty() || chunks.back()->count == chunkCapacity) {
+		if (spareChunk) {
+			chunks.push_back(std::move(spareChunk));
+		}
+		else {
+			chunks.push_back(std::make_unique<Chunk>());
+		}
+	}
+	Chunk& chunk = *chunks.back();
+	chunkIndex = static_cast<int>(chunks.size()) - 1;
+	row = chunk.count++;
+	GetEntities(chunk)[row] = entityId;
+}
+
+int Archetype::FreeRow(int chunkIndex, int row) {
+	Chunk& lastChunk = *chunks.back();
+	const int lastChunkIndex = static_cast<int>(chunks.size()) - 1;
+	const int lastRow = lastChunk.count - 1;
+	int movedEntityId = -1;
+
+	if (chunkIndex != lastChunkIndex || row != lastRow) {
+		Chunk& chunk = *chunks[chunkIndex];
+		for (size_t column = 0; column < columnInfos.size(); column++) {
+			void* last = GetComponent(lastChunk, static_cast<int>(column), lastRow);
+			columnInfos[column].moveConstruct(GetComponent(chunk, static_cast<int>(column), row), last);
+			columnInfos[column].destroy(last);
+			SetStamp(chunk, static_cast<int>(column), row, GetStamps(lastChunk, static_cast<int>(column))[lastRow]);
+		}
+		movedEntityId = GetEntities(lastChunk)[lastRow];
+		GetEntities(chunk)[row] = movedEntityId;
+	}
+
+	lastChunk.count--;
+	if (lastChunk.count == 0) {
+		spareChunk = std::move(chunks.back());
+		chunks.pop_back();
+	}
+	return movedEntityId;
+}
+
+Archetype* ArchetypeStorage::GetOrCreateArchetype(const Signature& signature) {
+	auto archetype = archetypes.find(signature);
+	if (archetype != archetypes.end()) {
+		return archetype->second.get();
+	}
+	std::unique_ptr<Archetype> newArchetype = std::make_unique<Archetype>(signature, componentInfos);
+	Archetype* result = newArchetype.get();
+	archetypes.emplace(signature, std::move(newArchetype));
+	archetypeList.push_back(result);
+
+	LOG_DEBUG(ECS, "Archetype created with signature = {}", signature.to_string());
+
+	return result;
+}
+
+void ArchetypeStorage::MoveEntity(int entityId, Archetype* target) {
+	EntityLocation& location = locations[entityId];
+	Archetype* source = location.archetype;
+
+	int chunkIndex = 0;
+	int row = 0;
+	if (target) {
+		target->AllocateRow(entityId, chunkIndex, row);
+	}
 
+	if (source) {
+		Chunk& sourceChunk = *source->chunks[location.chunk];
+		for (size_t column = 0; column < source->componentIds.size(); column++) {
+			void* component = source->GetComponent(sourceChunk, static_cast<int>(column), location.row);
+			const int targetColumn = target ? target->columns[source->componentIds[column]] : -1;
+			if (targetColumn != -1) {
+				Chunk& targetChunk = *target->chunks[chunkIndex];
+				source->columnInfos[column].moveConstruct(target->GetComponent(targetChunk, targetColumn, row), component);
+				target->SetStamp(targetChunk, targetColumn, row, source->GetStamps(sourceChunk, static_cast<int>(column))[location.row]);
+			}
+			source->columnInfos[column].destroy(component);
+		}
+
+		const int movedEntityId = source->FreeRow(location.chunk, location.row);
+		if (movedEntityId != -1) {
+			locations[movedEntityId] = location;
+		}
+	}
+
+	location = { target, chunkIndex, row };
+}
+
+bool ArchetypeStorage::Has(int entityId, int componentId) const {
+	if (entityId >= locations.size() || !locations[entityId].archetype) {
+		return false;
+	}
+	return locations[entityId].archetype->signature.test(componentId);
+}
+
+void* ArchetypeStorage::Get(int entityId, int componentId) const {
+	const EntityLocation& location = locations[entityId];
+	Archetype* archetype = location.archetype;
+	return archetype->GetComponent(*archetype->chunks[location.chunk], archetype->columns[componentId], location.row);
+}
+
+void* ArchetypeStorage::Add(int entityId, int componentId) {
+	if (entityId >= locations.size()) {
+		locations.resize(entityId + 1);
+	}
+	Archetype* source = locations[entityId].archetype;
+
+	Archetype* target = source ? source->addEdges[componentId] : nullptr;
+	if (!target) {
+		Signature signature = source ? source->signature : Signature();
+		signature.set(componentId);
+		target = GetOrCreateArchetype(signature);
+		if (source) {
+			source->addEdges[componentId] = target;
+			target->removeEdges[componentId] = source;
+		}
+	}
+
+	MoveEntity(entityId, target);
+	SetStamp(entityId, componentId, NewVersion(componentId));
+	return Get(entityId, componentId);
+}
+
+void ArchetypeStorage::Reserve(int numIds) {
+	if (numIds > locations.size()) {
+		locations.resize(numIds);
+	}
+}
+
+void ArchetypeStorage::Remove(int entityId, int componentId) {
+	if (!Has(entityId, componentId)) {
+		return;
+	}
+	Archetype* source = locations[entityId].archetype;
+
+	Archetype* target = source->removeEdges[componentId];
+	if (!target) {
+		Signature signature = source->signature;
+		signature.set(componentId, false);
+		// entities without any components don't live in an archetype
+		target = signature.none() ? nullptr : GetOrCreateArchetype(signature);
+		if (target) {
+			source->removeEdges[componentId] = target;
+			target->addEdges[componentId] = source;
+		}
+	}
+
+	MoveEntity(entityId, target);
+}
+
+void ArchetypeStorage::RemoveEntity(int entityId) {
+	if (entityId >= locations.size() || !locations[entityId].archetype) {
+		return;
+	}
+	MoveEntity(entityId, nullptr);
 }
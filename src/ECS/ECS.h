@@ -6,10 +6,29 @@
 #include <typeindex>
 #include <memory>
 #include <set>
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+#include <new>
+#include <deque>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <cstdlib>
 #include "../Logger/Logger.h"
+#include "../Jobs/JobSystem.h"
 
 const unsigned int MAX_COMPONENTS = 32;
 
+// an entity handle is 32 bits: the index of the entity and the generation of the index
+// the generation gets increased every time an index is reused, so old handles can be detected
+const unsigned int ENTITY_INDEX_BITS = 20;
+const unsigned int ENTITY_GENERATION_BITS = 12;
+const unsigned int ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+const unsigned int ENTITY_GENERATION_MASK = (1u << ENTITY_GENERATION_BITS) - 1;
+const unsigned int MAX_ENTITIES = 1u << ENTITY_INDEX_BITS;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Signature
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +37,35 @@ const unsigned int MAX_COMPONENTS = 32;
 typedef std::bitset<MAX_COMPONENTS> Signature;
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Span
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// non-owning view of objects which lie next to each other in memory (like std::span of C++20)
+template <typename T>
+class Span {
+private:
+	T* data = nullptr;
+	size_t size = 0;
+
+public:
+	Span() = default;
+	Span(T* data, size_t size) : data(data), size(size) {}
+	// any container with data() and size(), like std::vector (a Span itself still gets copied)
+	template <typename TContainer, typename = decltype(std::declval<TContainer&>().data())>
+	Span(TContainer& container) : data(container.data()), size(container.size()) {}
+	template <typename U> Span(const Span<U>& other) : data(other.GetData()), size(other.GetSize()) {}
+
+	T* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+	bool IsEmpty() const { return size == 0; }
+
+	T& operator [](size_t index) const { return data[index]; }
+	T* begin() const { return data; }
+	T* end() const { return data + size; }
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Component
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -44,22 +92,29 @@ public:
 // Entity
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-// class for all the entities (only an numerical ID)
+// class for all the entities (only a numerical handle made of index + generation)
 class Entity {
 private:
-	int id;
+	uint32_t handle;
 
 public:
-	Entity(int id) : id(id) {};
+	Entity(int id, int generation = 0) : handle((static_cast<uint32_t>(generation) << ENTITY_INDEX_BITS) | static_cast<uint32_t>(id)) {};
 	Entity(const Entity& entity) = default;
-	// Get the ID of an Entity
+	// Get the ID of an Entity (the index, used for the pools and signatures)
 	int GetId() const;
+	// Get how often the ID was reused before this Entity
+	int GetGeneration() const;
+	// Get the whole 32 bit handle (index + generation)
+	uint32_t GetHandle() const;
 
 	Entity& operator =(const Entity& other) = default;
-	bool operator ==(const Entity& other) const { return id == other.id; }
-	bool operator !=(const Entity& other) const { return id != other.id; }
-	bool operator <(const Entity& other) const { return id < other.id; }
-	bool operator >(const Entity& other) const { return id > other.id; }
+	bool operator ==(const Entity& other) const { return handle == other.handle; }
+	bool operator !=(const Entity& other) const { return handle != other.handle; }
+	bool operator <(const Entity& other) const { return handle < other.handle; }
+	bool operator >(const Entity& other) const { return handle > other.handle; }
+
+	// destroys the entity with all its components in the next Update() of the registry
+	void Kill();
 
 	// adds a component of type TComponent with the arguments TArgs
 	template <typename TComponent, typename ...TArgs> void AddComponent(TArgs&& ...args);
@@ -67,8 +122,12 @@ public:
 	template <typename TComponent> void RemoveComponent();
 	// checks if an entity has a component of type TComponent
 	template <typename TComponent> bool HasComponent() const;
-	// returns a reference to a specific component from an Entity
+	// returns a reference to a specific component from an Entity, the component counts as changed
 	template <typename TComponent> TComponent& GetComponent() const;
+	// the component for reading, it doesn't count as changed (like the const Registry::GetComponent())
+	template <typename TComponent> const TComponent& ReadComponent() const;
+	// calls function(component) and marks the component as changed
+	template <typename TComponent, typename TFunction> void Patch(TFunction function) const;
 
 	class Registry* registry;
 };
@@ -78,72 +137,325 @@ public:
 // System
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// how a system uses a component, so the scheduler knows which systems can run at the same time
+enum class ComponentAccess {
+	Read,
+	ReadWrite
+};
+
 // processes entities that contain a specific signature (logic)
 class System {
 private:
 	Signature componentSignature;
+	Signature readComponents; // components the system only reads
+	Signature writeComponents; // components the system changes
 	std::vector<Entity> entities;
+	bool isParallel = false;
+	uint32_t membershipVersion = 0; // counts the added and removed entities
+
+	// position of every entity in entities so it can be removed without searching
+	// [vector index = entity id] = index in entities or -1
+	std::vector<int> entityIndices;
 
 public:
 	System() = default;
 	~System() = default;
 
 	void AddEntityToSystem(Entity entity);
+	// swaps the last entity into the hole, so the order of the entities can change
 	void RemoveEntityFromSystem(Entity entity);
-	std::vector<Entity> GetSystemEnties() const; // getting the Entities in the System
+	bool HasEntity(Entity entity) const;
+	Span<const Entity> GetSystemEnties() const; // getting the Entities in the System (no copy, invalid after adding/removing entities)
+	// changes whenever an entity gets added or removed, also if the amount of entities stays the same
+	uint32_t GetMembershipVersion() const;
 	const Signature& GetComponentSignature() const; // getting the signature of the Components assigned to this System
 
+	// opt in to split the entities over the job system of the registry (if the system supports it)
+	void SetParallel(bool parallel);
+	bool IsParallel() const;
+
 	// component which entities need if the system should run at them
-	template <typename TComponent> void RequireComponent();
+	template <typename TComponent> void RequireComponent(ComponentAccess access = ComponentAccess::ReadWrite);
+	// component the system uses without requiring it (for example of other entities)
+	template <typename TComponent> void UseComponent(ComponentAccess access);
+
+	const Signature& GetReadComponents() const;
+	const Signature& GetWriteComponents() const;
+	// true if one of the systems writes a component the other one reads or writes
+	bool ConflictsWith(const System& other) const;
+
+	class Registry* registry = nullptr;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Scheduler
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// runs the scheduled systems of the registry every frame
+// two systems conflict if one of them writes a component the other one reads or writes,
+// a system always runs after the conflicting systems which were scheduled before it
+// the systems get grouped into levels: a level only depends on the levels before it,
+// so the systems of one level run at the same time on the job system
+// the order only depends on the order of scheduling and the declared components, so it is the same every frame
+class Scheduler {
+private:
+	struct ScheduledSystem {
+		System* system;
+		void (*update)(System* system, double deltaTime);
+		std::string name;
+	};
+
+	std::vector<ScheduledSystem> systems; // in order of scheduling
+	std::vector<std::vector<int>> levels; // [level][i] = index in systems
+	bool isDirty = false;
+
+	// builds the dependency graph and the levels again (only after systems changed)
+	void Build();
+	void RunSystem(int index, double deltaTime);
+
+public:
+	// the system needs an Update(double deltaTime) function
+	template <typename TSystem> void Add(TSystem* system, const std::string& name);
+	void Remove(System* system);
+
+	void Run(double deltaTime, JobSystem* jobSystem);
+
+	// the levels with the names of their systems, one line per level
+	std::string GetExecutionOrder();
 };
 
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Pool
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Inheritance Pool class so you don't have to specify the type of the Pool in the registry
 class IPool {
+protected:
+	uint32_t version = 0; // version of the newest change in the pool
+
 public:
 	virtual ~IPool() {}
+
+	uint32_t GetVersion() const {
+		return version;
+	}
+
+	uint32_t NewVersion() {
+		return ++version;
+	}
+
+	// removes the component of the entity (if it has one) without knowing the type
+	virtual void RemoveEntityFromPool(int entityId) = 0;
 };
 
 
-// a vector of objects of type T
+// sparse set of objects of type T
+// the components are packed densely in data, so iterating a pool only touches live components
+// and the memory grows with the amount of components, not with the amount of entities
+// data is raw aligned memory: only the slots in use hold constructed components,
+// components get constructed in place and are only ever moved, so they don't have to be copyable
 template <typename T> class Pool: public IPool {
+public:
+	// the stamps are grouped into blocks with the newest stamp of each block,
+	// so ViewChanged can skip the blocks without changes
+	static constexpr int STAMP_BLOCK_SIZE = 1024;
+
 private:
-	std::vector<T> data;
+	// entity ids get split into pages so a component only a few entities use
+	// doesn't need a slot for every entity
+	static constexpr int PAGE_SIZE = 1024;
+	static constexpr int INVALID_INDEX = -1;
+
+	T* data = nullptr; // [dense index] = component
+	size_t size = 0; // constructed components in data
+	size_t capacity = 0;
+	std::vector<int> entities; // [dense index] = entity id
+	std::vector<uint32_t> stamps; // [dense index] = version of the last change of the component
+	std::deque<std::atomic<uint32_t>> blockVersions; // [dense index / STAMP_BLOCK_SIZE] = newest stamp in the block
+	std::vector<std::unique_ptr<int[]>> sparse; // [entity id / PAGE_SIZE][entity id % PAGE_SIZE] = dense index
+
+	int GetIndex(int entityId) const {
+		const size_t page = entityId / PAGE_SIZE;
+		if (page >= sparse.size() || !sparse[page]) {
+			return INVALID_INDEX;
+		}
+		return sparse[page][entityId % PAGE_SIZE];
+	}
+
+	void SetIndex(int entityId, int index) {
+		const size_t page = entityId / PAGE_SIZE;
+		if (page >= sparse.size()) {
+			sparse.resize(page + 1);
+		}
+		if (!sparse[page]) {
+			sparse[page] = std::make_unique<int[]>(PAGE_SIZE);
+			std::fill(sparse[page].get(), sparse[page].get() + PAGE_SIZE, INVALID_INDEX);
+		}
+		sparse[page][entityId % PAGE_SIZE] = index;
+	}
+
+	// different entities can be stamped from different threads, but only existing slots
+	void Stamp(size_t index, uint32_t version) {
+		stamps[index] = version;
+		std::atomic<uint32_t>& blockVersion = blockVersions[index / STAMP_BLOCK_SIZE];
+		uint32_t newest = blockVersion.load(std::memory_order_relaxed);
+		while (newest < version && !blockVersion.compare_exchange_weak(newest, version, std::memory_order_relaxed)) {
+		}
+	}
+
+	static T* AllocateData(size_t capacity) {
+		return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+	}
+
+	static void FreeData(T* data) {
+		::operator delete(data, std::align_val_t(alignof(T)));
+	}
+
 public:
-	Pool(int size = 100) {
-		data.resize(size);
+	Pool(int capacity = 100) {
+		Reserve(capacity);
+	}
+	virtual ~Pool() {
+		Clear();
+		FreeData(data);
+	}
+	Pool(const Pool&) = delete;
+	Pool& operator =(const Pool&) = delete;
+
+	// moves the components into a bigger allocation
+	void Reserve(size_t newCapacity) {
+		if (newCapacity <= capacity) {
+			return;
+		}
+		T* newData = AllocateData(newCapacity);
+		for (size_t i = 0; i < size; i++) {
+			new (&newData[i]) T(std::move(data[i]));
+			data[i].~T();
+		}
+		FreeData(data);
+		data = newData;
+		capacity = newCapacity;
+		entities.reserve(newCapacity);
+		stamps.reserve(newCapacity);
 	}
-	virtual ~Pool() = default;
 
 	bool IsEmpty() const {
-		return data.empty();
+		return size == 0;
 	}
 
+	// amount of components in the pool
 	size_t GetSize() const {
-		return data.size();
+		return size;
 	}
 
-	void Resize(int n) {
-		data.resize(n);
-	} 
-
 	void Clear() {
-		data.clear();
+		for (size_t i = 0; i < size; i++) {
+			data[i].~T();
+		}
+		size = 0;
+		entities.clear();
+		stamps.clear();
+		blockVersions.clear();
+		sparse.clear();
+	}
+
+	bool Has(int entityId) const {
+		return GetIndex(entityId) != INVALID_INDEX;
+	}
+
+	// constructs the component of the entity in place with the arguments TArgs,
+	// a component the entity already has gets replaced (move assigned)
+	// either way the component counts as changed
+	template <typename ...TArgs> T& Emplace(int entityId, TArgs&& ...args) {
+		const int index = GetIndex(entityId);
+		if (index != INVALID_INDEX) {
+			// constructed first, the arguments can be the old component and a throwing constructor leaves it alive
+			T object(std::forward<TArgs>(args)...);
+			data[index] = std::move(object);
+			Stamp(index, NewVersion());
+			return data[index];
+		}
+		if (size == capacity) {
+			// the arguments can point into the storage which Reserve() frees
+			T object(std::forward<TArgs>(args)...);
+			Reserve(capacity ? capacity * 2 : 16);
+			return Emplace(entityId, std::move(object));
+		}
+		T* component = new (&data[size]) T(std::forward<TArgs>(args)...);
+		SetIndex(entityId, static_cast<int>(size));
+		entities.push_back(entityId);
+		stamps.push_back(0);
+		if (size / STAMP_BLOCK_SIZE == blockVersions.size()) {
+			blockVersions.emplace_back(0);
+		}
+		Stamp(size, NewVersion());
+		size++;
+		return *component;
 	}
 
-	void Add(T object) {
-		data.push_back(object);
+	// adds the component to the entity or overwrites the one it already has
+	void Set(int entityId, const T& object) {
+		Emplace(entityId, object);
 	}
 
-	void Set(int index, T object) {
-		data[index] = object;
+	void Set(int entityId, T&& object) {
+		Emplace(entityId, std::move(object));
 	}
 
-	T& Get(int index) {
-		return static_cast<T&>(data[index]);
+	// moves the last component into the hole so the data stays packed
+	void Remove(int entityId) {
+		const int index = GetIndex(entityId);
+		if (index == INVALID_INDEX) {
+			return;
+		}
+		const int lastIndex = static_cast<int>(size) - 1;
+		data[index].~T();
+		if (index != lastIndex) {
+			const int lastEntityId = entities[lastIndex];
+			new (&data[index]) T(std::move(data[lastIndex]));
+			data[lastIndex].~T();
+			entities[index] = lastEntityId;
+			Stamp(index, stamps[lastIndex]);
+			SetIndex(lastEntityId, index);
+		}
+		size--;
+		entities.pop_back();
+		stamps.pop_back();
+		SetIndex(entityId, INVALID_INDEX);
+	}
+
+	void RemoveEntityFromPool(int entityId) override {
+		Remove(entityId);
+	}
+
+	T& Get(int entityId) {
+		return data[GetIndex(entityId)];
+	}
+
+	// packed access for systems that iterate the whole pool
+	// [dense index] = component / entity id
+	T* GetData() {
+		return data;
+	}
+
+	const int* GetEntities() const {
+		return entities.data();
+	}
+
+	const uint32_t* GetStamps() const {
+		return stamps.data();
+	}
+
+	// newest stamp of the components [block * STAMP_BLOCK_SIZE, (block + 1) * STAMP_BLOCK_SIZE)
+	uint32_t GetBlockVersion(size_t block) const {
+		return blockVersions[block].load(std::memory_order_relaxed);
+	}
+
+	// marks the component of the entity as changed in the given version
+	// different entities can be marked from different threads
+	void SetStamp(int entityId, uint32_t version) {
+		Stamp(GetIndex(entityId), version);
 	}
 
 	T& operator [](unsigned int index) {
@@ -152,6 +464,493 @@ public:
 };
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Archetype
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// how the registry stores the components
+enum class StorageMode {
+	Pools, // one sparse set per component type (cheap to add and remove components)
+	Archetypes // entities with the same signature share chunks with one column per component (fast iteration)
+};
+
+// type erased functions to move and destroy components inside of archetype chunks
+struct ComponentInfo {
+	size_t size = 0;
+	size_t alignment = 0;
+	void (*moveConstruct)(void* destination, void* source) = nullptr;
+	void (*destroy)(void* component) = nullptr;
+
+	template <typename T> static ComponentInfo Create();
+};
+
+const size_t CHUNK_SIZE = 16 * 1024;
+
+// fixed size block of memory, the entity ids and every column of an archetype live in data
+struct alignas(64) Chunk {
+	int count = 0;
+	// newest stamp of any component in the chunk, ViewChanged skips the chunks without changes
+	std::atomic<uint32_t> version{ 0 };
+	alignas(64) std::byte data[CHUNK_SIZE - 64];
+};
+
+// all the entities which have exactly the same signature
+class Archetype {
+public:
+	Signature signature;
+	std::vector<int> componentIds; // [column index] = component type id
+	std::vector<ComponentInfo> columnInfos; // [column index] = how to move/destroy the component
+	std::vector<size_t> columnOffsets; // [column index] = byte offset of the column inside a chunk
+	std::vector<size_t> stampOffsets; // [column index] = byte offset of the change versions of the column
+	int columns[MAX_COMPONENTS]; // [component type id] = column index or -1
+	int chunkCapacity = 0; // entities per chunk
+
+	// every chunk is full except of the last one
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	// the last chunk which got empty is kept so entities moving back and forth don't allocate every time
+	std::unique_ptr<Chunk> spareChunk;
+
+	// cached transitions to the archetype with one component more/less
+	// [component type id] = archetype
+	Archetype* addEdges[MAX_COMPONENTS] = {};
+	Archetype* removeEdges[MAX_COMPONENTS] = {};
+
+	Archetype(const Signature& signature, const std::vector<ComponentInfo>& componentInfos);
+	~Archetype();
+
+	// places the entity ids and the columns for chunkCapacity entities, returns the bytes they need
+	size_t Layout();
+
+	int* GetEntities(Chunk& chunk) const {
+		return reinterpret_cast<int*>(chunk.data);
+	}
+
+	void* GetComponent(Chunk& chunk, int column, int row) const {
+		return chunk.data + columnOffsets[column] + row * columnInfos[column].size;
+	}
+
+	// column of the component type in a chunk, the archetype needs to have the component
+	template <typename T> T* GetColumn(Chunk& chunk, int componentId) const {
+		return reinterpret_cast<T*>(chunk.data + columnOffsets[columns[componentId]]);
+	}
+
+	// [row] = version of the last change of the component in the column
+	uint32_t* GetStamps(Chunk& chunk, int column) const {
+		return reinterpret_cast<uint32_t*>(chunk.data + stampOffsets[column]);
+	}
+
+	void SetStamp(Chunk& chunk, int column, int row, uint32_t version) const {
+		GetStamps(chunk, column)[row] = version;
+		// MarkChanged can run on several workers at once
+		uint32_t newest = chunk.version.load(std::memory_order_relaxed);
+		while (newest < version && !chunk.version.compare_exchange_weak(newest, version, std::memory_order_relaxed)) {
+		}
+	}
+
+	// reserves a row at the end of the archetype, the components of the row are not constructed yet
+	void AllocateRow(int entityId, int& chunkIndex, int& row);
+	// fills the hole with the last row of the archetype, the components of the row have to be destroyed already
+	// returns the id of the entity which moved into the hole or -1
+	int FreeRow(int chunkIndex, int row);
+};
+
+// where the components of an entity are stored
+struct EntityLocation {
+	Archetype* archetype = nullptr;
+	int chunk = 0;
+	int row = 0;
+};
+
+// groups entities by their signature into archetypes
+class ArchetypeStorage {
+private:
+	std::vector<ComponentInfo> componentInfos; // [component type id] = info
+	std::unordered_map<Signature, std::unique_ptr<Archetype>> archetypes;
+	std::vector<Archetype*> archetypeList; // for iterating, in order of creation
+	std::vector<EntityLocation> locations; // [entity id] = location
+	uint32_t versions[MAX_COMPONENTS] = {}; // [component type id] = version of the newest change
+
+	Archetype* GetOrCreateArchetype(const Signature& signature);
+	// moves all the components the target archetype has as well, destroys the others
+	void MoveEntity(int entityId, Archetype* target);
+
+public:
+	ArchetypeStorage() = default;
+	ArchetypeStorage(const ArchetypeStorage&) = delete;
+	ArchetypeStorage& operator =(const ArchetypeStorage&) = delete;
+
+	template <typename T> void RegisterComponent(int componentId);
+
+	bool Has(int entityId, int componentId) const;
+	void* Get(int entityId, int componentId) const;
+	// moves the entity to the archetype with the component and returns the memory
+	// where the component has to be constructed, the new component counts as changed
+	void* Add(int entityId, int componentId);
+	// makes room for the locations of the entity ids below numIds
+	void Reserve(int numIds);
+	void Remove(int entityId, int componentId);
+	void RemoveEntity(int entityId);
+
+	uint32_t GetVersion(int componentId) const {
+		return versions[componentId];
+	}
+
+	uint32_t NewVersion(int componentId) {
+		return ++versions[componentId];
+	}
+
+	// marks the component of the entity as changed in the given version
+	void SetStamp(int entityId, int componentId, uint32_t version) {
+		const EntityLocation& location = locations[entityId];
+		location.archetype->SetStamp(*location.archetype->chunks[location.chunk], location.archetype->columns[componentId], location.row, version);
+	}
+
+	const std::vector<Archetype*>& GetArchetypes() const {
+		return archetypeList;
+	}
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// View
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// iterates all the entities which have every component of TComponents, returned by Registry::View()
+// the typed pools (or the matching archetype chunks) are looked up once when the view is created,
+// so the loop itself has no virtual calls, no shared_ptr copies and no hashing
+// usage: for (auto [entity, transform, rigidBody] : registry.View<TransformComponent, RigidBodyComponent>())
+template <typename ...TComponents>
+class ComponentView {
+public:
+	using Tuple = std::tuple<Entity, TComponents&...>;
+
+	// a chunk of an archetype which has all the components
+	struct Block {
+		Archetype* archetype;
+		Chunk* chunk;
+	};
+
+private:
+	class Registry* registry;
+	const uint16_t* entityGenerations;
+	bool useArchetypes;
+
+	// pools: the smallest pool drives the loop, the others get checked
+	std::tuple<Pool<TComponents>*...> pools;
+	const int* driverEntities = nullptr;
+	int driverCount = 0;
+
+	// archetypes
+	std::vector<Block> blocks;
+
+	bool HasAll(int entityId) const {
+		return (std::get<Pool<TComponents>*>(pools)->Has(entityId) && ...);
+	}
+
+	Entity MakeEntity(int entityId) const {
+		Entity entity(entityId, entityGenerations[entityId]);
+		entity.registry = registry;
+		return entity;
+	}
+
+public:
+	ComponentView(class Registry* registry, const uint16_t* entityGenerations, Pool<TComponents>* ...componentPools);
+	ComponentView(class Registry* registry, const uint16_t* entityGenerations, std::vector<Block>&& blocks);
+
+	class Iterator {
+	private:
+		const ComponentView* view;
+		size_t block;
+		int row;
+		int count = 0;
+		const int* entityIds = nullptr;
+		std::tuple<TComponents*...> columns; // archetypes: the columns of the current chunk
+
+		void LoadBlock() {
+			if (!view->useArchetypes) {
+				entityIds = view->driverEntities;
+				count = view->driverCount;
+				return;
+			}
+			if (block >= view->blocks.size()) {
+				return;
+			}
+			const Block& current = view->blocks[block];
+			entityIds = current.archetype->GetEntities(*current.chunk);
+			count = current.chunk->count;
+			columns = std::make_tuple(current.archetype->template GetColumn<TComponents>(*current.chunk, Component<TComponents>::GetId())...);
+		}
+
+		// moves forward to the next entity which belongs to the view
+		void Settle() {
+			if (!view->useArchetypes) {
+				while (row < count && !view->HasAll(entityIds[row])) {
+					row++;
+				}
+				return;
+			}
+			while (row >= count && block < view->blocks.size()) {
+				block++;
+				row = 0;
+				LoadBlock();
+			}
+		}
+
+	public:
+		Iterator(const ComponentView* view, size_t block, int row) : view(view), block(block), row(row) {
+			LoadBlock();
+			Settle();
+		}
+
+		Tuple operator *() const {
+			const int entityId = entityIds[row];
+			if (view->useArchetypes) {
+				return Tuple(view->MakeEntity(entityId), std::get<TComponents*>(columns)[row]...);
+			}
+			return Tuple(view->MakeEntity(entityId), std::get<Pool<TComponents>*>(view->pools)->Get(entityId)...);
+		}
+
+		Iterator& operator ++() {
+			row++;
+			Settle();
+			return *this;
+		}
+
+		bool operator ==(const Iterator& other) const { return block == other.block && row == other.row; }
+		bool operator !=(const Iterator& other) const { return !(*this == other); }
+	};
+
+	Iterator begin() const {
+		return Iterator(this, 0, 0);
+	}
+
+	Iterator end() const {
+		if (useArchetypes) {
+			return Iterator(this, blocks.size(), 0);
+		}
+		return Iterator(this, 0, driverCount);
+	}
+
+	// number of pieces Each can be split into: rows of the driving pool or archetype chunks
+	int GetRangeSize() const {
+		return useArchetypes ? static_cast<int>(blocks.size()) : driverCount;
+	}
+
+	// calls function(entity, components...) for the entities in the pieces [begin, end) of the view
+	template <typename TFunction> void EachInRange(int begin, int end, TFunction& function) const {
+		if (useArchetypes) {
+			for (int blockIndex = begin; blockIndex < end; blockIndex++) {
+				const Block& block = blocks[blockIndex];
+				const int* entityIds = block.archetype->GetEntities(*block.chunk);
+				auto columns = std::make_tuple(block.archetype->template GetColumn<TComponents>(*block.chunk, Component<TComponents>::GetId())...);
+				for (int row = 0; row < block.chunk->count; row++) {
+					function(MakeEntity(entityIds[row]), std::get<TComponents*>(columns)[row]...);
+				}
+			}
+			return;
+		}
+		for (int row = begin; row < end; row++) {
+			const int entityId = driverEntities[row];
+			if (HasAll(entityId)) {
+				function(MakeEntity(entityId), std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+			}
+		}
+	}
+
+	// calls function(entity, components...) for every entity of the view
+	template <typename TFunction> void Each(TFunction function) const {
+		EachInRange(0, GetRangeSize(), function);
+	}
+
+	// like Each, but the entities get split over the workers of the job system
+	// with pools the rows of the driving pool get split, with archetypes the chunks
+	// the function must not add/remove components or entities, Registry::GetCommandBuffer() records them instead
+	template <typename TFunction> void ParallelEach(JobSystem& jobSystem, TFunction function) const;
+};
+
+// iterates the entities whose component TComponent changed after a version, returned by Registry::ViewChanged()
+// a pool and an archetype chunk look the same: packed entity ids, components and stamps
+// usage: for (auto [entity, transform] : registry.ViewChanged<TransformComponent>(lastVersion))
+template <typename TComponent>
+class ChangedView {
+public:
+	using Tuple = std::tuple<Entity, TComponent&>;
+
+	struct Block {
+		const int* entityIds;
+		TComponent* components;
+		const uint32_t* stamps;
+		int count;
+	};
+
+private:
+	class Registry* registry;
+	const uint16_t* entityGenerations;
+	uint32_t sinceVersion;
+	std::vector<Block> blocks;
+
+	Entity MakeEntity(int entityId) const {
+		Entity entity(entityId, entityGenerations[entityId]);
+		entity.registry = registry;
+		return entity;
+	}
+
+public:
+	ChangedView(class Registry* registry, const uint16_t* entityGenerations, uint32_t sinceVersion, std::vector<Block>&& blocks)
+		: registry(registry), entityGenerations(entityGenerations), sinceVersion(sinceVersion), blocks(std::move(blocks)) {
+	}
+
+	class Iterator {
+	private:
+		const ChangedView* view;
+		size_t block;
+		int row;
+
+		// moves forward to the next changed component
+		void Settle() {
+			while (block < view->blocks.size()) {
+				const Block& current = view->blocks[block];
+				while (row < current.count && current.stamps[row] <= view->sinceVersion) {
+					row++;
+				}
+				if (row < current.count) {
+					return;
+				}
+				block++;
+				row = 0;
+			}
+		}
+
+	public:
+		Iterator(const ChangedView* view, size_t block, int row) : view(view), block(block), row(row) {
+			Settle();
+		}
+
+		Tuple operator *() const {
+			const Block& current = view->blocks[block];
+			return Tuple(view->MakeEntity(current.entityIds[row]), current.components[row]);
+		}
+
+		Iterator& operator ++() {
+			row++;
+			Settle();
+			return *this;
+		}
+
+		bool operator ==(const Iterator& other) const { return block == other.block && row == other.row; }
+		bool operator !=(const Iterator& other) const { return !(*this == other); }
+	};
+
+	Iterator begin() const {
+		return Iterator(this, 0, 0);
+	}
+
+	Iterator end() const {
+		return Iterator(this, blocks.size(), 0);
+	}
+
+	// calls function(entity, component) for every changed component
+	template <typename TFunction> void Each(TFunction function) const {
+		for (const Block& block : blocks) {
+			for (int row = 0; row < block.count; row++) {
+				if (block.stamps[row] > sinceVersion) {
+					function(MakeEntity(block.entityIds[row]), block.components[row]);
+				}
+			}
+		}
+	}
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CommandBuffer
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// entity created by a command buffer, it only gets a real id when the buffer is played back
+struct DeferredEntity {
+	int index; // [index in the created entities of the buffer]
+	uint32_t sortKey;
+};
+
+// records structural changes (create/kill entities, add/remove components) instead of doing them,
+// so systems running on the job system can spawn bullets etc. without locking the registry
+// every worker thread has its own buffer (Registry::GetCommandBuffer()), all buffers get played back
+// at the start of Registry::Update() sorted by (sort key, job key, order of recording)
+// the job key says which system and which range of a ParallelEach recorded the command, a job runs on one thread,
+// so the result doesn't depend on which worker recorded what
+// the commands and the components live in a linear arena which keeps its memory for the next frame
+class CommandBuffer {
+private:
+	enum class CommandType {
+		CreateEntity,
+		KillEntity,
+		AddComponent,
+		RemoveComponent
+	};
+
+	struct Command {
+		CommandType type;
+		uint32_t sortKey;
+		uint64_t jobKey;
+		uint32_t sequence; // order of recording in this buffer
+		Entity entity = Entity(0);
+		int deferredIndex = -1; // the command targets a DeferredEntity of this buffer
+		void* component = nullptr; // AddComponent: the component waiting in the arena
+		void (*addComponent)(class Registry& registry, Entity entity, void* component) = nullptr;
+		void (*removeComponent)(class Registry& registry, Entity entity) = nullptr;
+		void (*destroyComponent)(void* component) = nullptr;
+		CommandBuffer* buffer;
+	};
+
+	struct Block {
+		std::unique_ptr<std::byte[]> memory;
+		size_t size;
+		size_t used;
+	};
+
+	static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+	std::vector<Block> blocks;
+	size_t currentBlock = 0;
+	std::vector<Command*> commands;
+	std::vector<Entity> createdEntities; // [DeferredEntity index] = entity after the playback
+	uint32_t sortKey = 0;
+	// (index of the running system in the scheduler + 1) << 48 | number of the ParallelEach in the system << 32
+	// | (first row of the ParallelEach range + 1), 0 outside of the systems
+	// set by the Scheduler and ParallelEach for the thread which runs the job
+	uint64_t jobKey = 0;
+	uint32_t nextSequence = 0;
+	uint32_t index = 0; // in Registry::commandBuffers, only decides between commands recorded outside of the systems
+
+	void* Allocate(size_t size, size_t alignment);
+	Command* AddCommand(CommandType type);
+	// destroys the components which didn't get played back and keeps the memory
+	void Reset();
+
+	friend class Registry;
+	friend class Scheduler;
+	template <typename ...TComponents> friend class ComponentView;
+
+public:
+	CommandBuffer() = default;
+	~CommandBuffer();
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator =(const CommandBuffer&) = delete;
+
+	// commands get played back in the order of their sort key, for example the id of the entity
+	// a system was processing when it recorded them, the key goes back to 0 after the playback
+	void SetSortKey(uint32_t key);
+
+	DeferredEntity CreateEntity();
+	void KillEntity(Entity entity);
+	template <typename TComponent, typename ...TArgs> void AddComponent(Entity entity, TArgs&& ...args);
+	template <typename TComponent, typename ...TArgs> void AddComponent(DeferredEntity entity, TArgs&& ...args);
+	template <typename TComponent> void RemoveComponent(Entity entity);
+
+	bool IsEmpty() const;
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Registry
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -159,44 +958,139 @@ public:
 // manages the whole Entity-Component-System System (main Manager)
 class Registry {
 private:
-	int numEntities = 0;
-	std::set<Entity> entitesToBeAdded; // Entities waiting for creation in next Update()
+	StorageMode storageMode;
+	int numEntities = 0; // amount of entity ids ever used (alive or free)
+	std::vector<Entity> entitesToBeAdded; // Entities waiting for creation in next Update()
 	std::set<Entity> entitesToBeRemoved; // Entities waiting for destruction in next Update()
 
+	// ids of destroyed entities, which can be reused by CreateEntity()
+	// the oldest id gets reused first so the generations wrap around as late as possible
+	std::deque<int> freeIds;
+
+	// current generation of every id
+	// [vector index = entity id]
+	std::vector<uint16_t> entityGenerations;
+
 	// Vector of component pools, each pool contains all the data for a certain component type
 	// [Vector index = component type id]
-	// [Pool index = entity id]
-	std::vector<std::shared_ptr<IPool>> componentPools;
+	// [Pool is a sparse set indexed by entity id]
+	std::vector<std::unique_ptr<IPool>> componentPools;
+
+	// components grouped by signature, only used with StorageMode::Archetypes
+	ArchetypeStorage archetypes;
 
 	// list which holds information about which component is used for which entity 
 	// [vector index = entity id]
 	std::vector<Signature> entityComponentSignatures;
 
+	// the signature of every entity like the systems know it (the state of the last Update())
+	// AddComponent/RemoveComponent only queue the entity, Update() applies the difference in one batch
+	// [vector index = entity id]
+	std::vector<Signature> systemEntitySignatures;
+	std::vector<Entity> entitiesWithChangedSignature;
+	std::vector<bool> signatureChangeQueued; // [vector index = entity id] so an entity is only queued once
+	std::vector<bool> entitiesInSystems; // [vector index = entity id] the entity was added to the systems and isn't killed yet
+
 	std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
 
+	JobSystem* jobSystem = nullptr;
+	Scheduler scheduler;
+
+	// [vector index = worker index of the job system] (only one buffer without job system)
+	std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;
+	std::vector<CommandBuffer::Command*> commandsToPlayback; // kept to not allocate every frame
+
+	// applies the commands of all the buffers in a deterministic order
+	void PlaybackCommandBuffers();
+
+	// which systems require a component, so a changed component only touches these systems
+	// [array index = component type id]
+	std::vector<System*> systemsByComponent[MAX_COMPONENTS];
+	// systems which don't require any component are interested in every entity
+	std::vector<System*> systemsWithoutComponents;
+
+	// makes the per-entity lists big enough for the entity ids below numIds
+	void ReserveEntityIds(int numIds);
+	void QueueSignatureChange(Entity entity);
+	// adds/removes the entity to/from the systems which require one of the changed components
+	void ApplySignatureChange(Entity entity, const Signature& oldSignature, const Signature& newSignature);
+	// puts the system into systemsByComponent and adds the existing entities to it
+	void AddSystemToIndex(System* system);
+	void RemoveSystemFromIndex(System* system);
+
 public:
-	Registry() {
-		Logger::trace("Registry constructor called!");
+	Registry(StorageMode storageMode = StorageMode::Pools) : storageMode(storageMode) {
+		commandBuffers.push_back(std::make_unique<CommandBuffer>());
+		LOG_TRACE(ECS, "Registry constructor called!");
 	} // = default;
 
 	~Registry() {
-		Logger::trace("Registry destructor called!");
+		LOG_TRACE(ECS, "Registry destructor called!");
 	} // = default;
 
 
+	// plays back the command buffers, adds the created entities to the systems,
+	// applies the changed signatures and destroys the killed ones
 	void Update();
+	// aborts when all MAX_ENTITIES ids are alive
 	Entity CreateEntity();
-	//void AddEntityToSystem(Entity entity);
-	//void KillEntity(Entity entity);
-
-	// adds a component of type TComponent with the arguments TArgs
+	// creates count entities at once (for level loading), the lists only grow once
+	std::vector<Entity> CreateEntities(int count);
+	// the entity gets destroyed in the next Update()
+	void KillEntity(Entity entity);
+	// false if the entity was destroyed (its id may already be used by a new entity)
+	bool IsAlive(Entity entity) const;
+
+	// adding and removing components of a dead entity (stale handle) gets logged and does nothing
+	// adds a component of type TComponent, constructed in place with the arguments TArgs
 	template <typename TComponent, typename ...TArgs> void AddComponent(Entity entity, TArgs&& ...args);
+	// adds components[i] to entities[i], the storage is reserved once for all of them
+	template <typename TComponent> void AddComponents(Span<const Entity> entities, Span<const TComponent> components);
 	// removes an component of type TComponent
 	template <typename TComponent> void RemoveComponent(Entity entity);
 	// checks if an entity has a component of type TComponent
 	template <typename TComponent> bool HasComponent(Entity entity) const;
-	// returns a reference to a specific component from an Entity
-	template <typename TComponent> TComponent& GetComponent(Entity entity) const;	
+	// returns a reference to a specific component from an Entity, the component counts as changed
+	template <typename TComponent> TComponent& GetComponent(Entity entity);
+	// read only access, doesn't change the version
+	template <typename TComponent> const TComponent& GetComponent(Entity entity) const;
+	// write access without a stamp, for changing a lot of components with one version:
+	// const uint32_t version = registry.NewVersion<T>(); ... registry.GetComponentUnmarked<T>(entity) = ...; registry.MarkChanged<T>(entity, version);
+	template <typename TComponent> TComponent& GetComponentUnmarked(Entity entity);
+
+	// change tracking: every change of a component (add, GetComponent, Patch, MarkChanged) stamps it
+	// with a new version of its component type, ViewChanged only visits the components stamped later
+	// usage: const uint32_t version = registry.GetVersion<T>();
+	//        for (auto [entity, component] : registry.ViewChanged<T>(lastVersion)) {...}
+	//        lastVersion = version;
+	template <typename TComponent> uint32_t GetVersion() const;
+	// calls function(component) and marks the component as changed
+	template <typename TComponent, typename TFunction> void Patch(Entity entity, TFunction function);
+	template <typename TComponent> void MarkChanged(Entity entity);
+	// for marking a lot of components with one version, also from the workers of the job system:
+	// const uint32_t version = registry.NewVersion<T>(); ... registry.MarkChanged<T>(entity, version);
+	template <typename TComponent> uint32_t NewVersion();
+	template <typename TComponent> void MarkChanged(Entity entity, uint32_t version);
+	// the entities whose component TComponent changed after sinceVersion, see ChangedView
+	template <typename TComponent> ChangedView<TComponent> ViewChanged(uint32_t sinceVersion);
+
+	// typed pool of the component or nullptr if no entity ever had the component (only with StorageMode::Pools)
+	template <typename TComponent> Pool<TComponent>* GetPool() const;
+	// all the entities with all the components, see ComponentView
+	template <typename ...TComponents> ComponentView<TComponents...> View();
+
+	StorageMode GetStorageMode() const;
+
+	// job system which parallel systems use to split their work, nullptr = everything runs on the calling thread
+	void SetJobSystem(JobSystem* jobSystem);
+	JobSystem* GetJobSystem() const;
+	// buffer of the calling thread for structural changes while the systems run on the job system
+	// threads which don't belong to the job system share one buffer and must not record at the same time
+	CommandBuffer& GetCommandBuffer();
+	// calls function(count, entityIds, TComponents*...) for every block of entities which have all the components
+	// with archetypes a block is a whole chunk with the columns packed next to each other,
+	// with pools every block is one entity
+	template <typename ...TComponents, typename TFunction> void ForEachChunk(TFunction function);
 
 	// adds a system of type TSystem with the arguments TArgs
 	template <typename TSystem, typename ...TArgs> void AddSystem(TArgs&& ...args);
@@ -206,10 +1100,17 @@ public:
 	template <typename TSystem> bool HasSystem() const;
 	// returns the system of type TSystem from the registry
 	template <typename TSystem> TSystem& GetSystem() const;
+	// lets RunSystems() update the system (which has to be added already), see Scheduler
+	template <typename TSystem> void ScheduleSystem();
+	// updates the scheduled systems, the ones which don't conflict run at the same time on the job system
+	void RunSystems(double deltaTime);
+	Scheduler& GetScheduler();
 
 	// Checks the component Signature of an entity and add the entity to the
 	// that are interested in it
 	void AddEntityToSystems(Entity entity);
+	// removes the entity from every system it is in
+	void RemoveEntityFromSystems(Entity entity);
 };
 
 
@@ -218,20 +1119,58 @@ public:
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename TComponent>
-void System::RequireComponent() {
+void System::RequireComponent(ComponentAccess access) {
 	const int componentId = Component<TComponent>::GetId();
 	componentSignature.set(componentId);
+	UseComponent<TComponent>(access);
+}
+
+template <typename TComponent>
+void System::UseComponent(ComponentAccess access) {
+	const int componentId = Component<TComponent>::GetId();
+	if (access == ComponentAccess::ReadWrite) {
+		writeComponents.set(componentId);
+		readComponents.set(componentId, false);
+	}
+	else if (!writeComponents.test(componentId)) {
+		readComponents.set(componentId);
+	}
+}
+
+template <typename TSystem>
+void Scheduler::Add(TSystem* system, const std::string& name) {
+	ScheduledSystem scheduledSystem;
+	scheduledSystem.system = system;
+	scheduledSystem.update = [](System* system, double deltaTime) {
+		static_cast<TSystem*>(system)->Update(deltaTime);
+	};
+	scheduledSystem.name = name;
+	systems.push_back(scheduledSystem);
+	isDirty = true;
+}
+
+template <typename TSystem>
+void Registry::ScheduleSystem() {
+	scheduler.Add<TSystem>(&GetSystem<TSystem>(), typeid(TSystem).name());
 }
 
 template <typename TSystem, typename ...TArgs>
 void Registry::AddSystem(TArgs&& ...args) {
 	std::shared_ptr<TSystem> newSystem = std::make_shared<TSystem>(std::forward<TArgs>(args)...);
-	systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
+	newSystem->registry = this;
+	if (systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem)).second) {
+		AddSystemToIndex(newSystem.get());
+	}
 }
 
 template <typename TSystem>
 void Registry::RemoveSystem() {
 	auto system = systems.find(std::type_index(typeid(TSystem)));
+	if (system == systems.end()) {
+		return;
+	}
+	RemoveSystemFromIndex(system->second.get());
+	scheduler.Remove(system->second.get());
 	systems.erase(system);
 }
 
@@ -252,28 +1191,95 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args) {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
 
+	// a stale handle would change the entity which got the id afterwards
+	if (!IsAlive(entity)) {
+		LOG_ERROR(ECS, "Component id = {} wasn't added, entity id {} generation {} isn't alive", componentId, entityId, entity.GetGeneration());
+		return;
+	}
+
 	if (componentId >= componentPools.size()) {
-		componentPools.resize(componentId + 1, nullptr);
+		componentPools.resize(componentId + 1);
 	}
 
-	if (!componentPools[componentId]) {
-		std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>();
-		componentPools[componentId] = newComponentPool;
+	if (!componentPools[componentId] && storageMode == StorageMode::Pools) {
+		componentPools[componentId] = std::make_unique<Pool<TComponent>>();
 	}
 
-	std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+	if (storageMode == StorageMode::Archetypes) {
+		archetypes.RegisterComponent<TComponent>(componentId);
+		// constructed first: the arguments can be the old component or another component of the entity,
+		// which moves to another chunk in Add(), and a throwing constructor leaves the storage untouched
+		TComponent object(std::forward<TArgs>(args)...);
+		if (entityComponentSignatures[entityId].test(componentId)) {
+			*static_cast<TComponent*>(archetypes.Get(entityId, componentId)) = std::move(object);
+			archetypes.SetStamp(entityId, componentId, archetypes.NewVersion(componentId));
+		}
+		else {
+			new (archetypes.Add(entityId, componentId)) TComponent(std::move(object));
+		}
+	}
+	else {
+		GetPool<TComponent>()->Emplace(entityId, std::forward<TArgs>(args)...);
+	}
 
-	if (entityId >= componentPool->GetSize()) {
-		componentPool->Resize(numEntities);
+	if (!entityComponentSignatures[entityId].test(componentId)) {
+		entityComponentSignatures[entityId].set(componentId);
+		QueueSignatureChange(entity);
 	}
 
-	TComponent newComponent(std::forward<TArgs>(args)...);
+	LOG_DEBUG(ECS, "Component id = {} was added to entity id {}", componentId, entityId);
+}
 
-	componentPool->Set(entityId, newComponent);
+template <typename TComponent>
+void Registry::AddComponents(Span<const Entity> entities, Span<const TComponent> components) {
+	const int componentId = Component<TComponent>::GetId();
+	const size_t count = std::min(entities.GetSize(), components.GetSize());
+
+	for (size_t i = 0; i < count; i++) {
+		if (!IsAlive(entities[i])) {
+			LOG_ERROR(ECS, "Component id = {} wasn't added to {} entities, entity id {} generation {} isn't alive", componentId, count, entities[i].GetId(), entities[i].GetGeneration());
+			return;
+		}
+	}
+
+	if (componentId >= componentPools.size()) {
+		componentPools.resize(componentId + 1);
+	}
+
+	if (storageMode == StorageMode::Archetypes) {
+		archetypes.RegisterComponent<TComponent>(componentId);
+		archetypes.Reserve(numEntities);
+		for (size_t i = 0; i < count; i++) {
+			const int entityId = entities[i].GetId();
+			if (entityComponentSignatures[entityId].test(componentId)) {
+				*static_cast<TComponent*>(archetypes.Get(entityId, componentId)) = components[i];
+				archetypes.SetStamp(entityId, componentId, archetypes.NewVersion(componentId));
+			}
+			else {
+				new (archetypes.Add(entityId, componentId)) TComponent(components[i]);
+			}
+		}
+	}
+	else {
+		if (!componentPools[componentId]) {
+			componentPools[componentId] = std::make_unique<Pool<TComponent>>();
+		}
+		Pool<TComponent>* componentPool = GetPool<TComponent>();
+		componentPool->Reserve(componentPool->GetSize() + count);
+		for (size_t i = 0; i < count; i++) {
+			componentPool->Emplace(entities[i].GetId(), components[i]);
+		}
+	}
 
-	entityComponentSignatures[entityId].set(componentId);
+	for (size_t i = 0; i < count; i++) {
+		const int entityId = entities[i].GetId();
+		if (!entityComponentSignatures[entityId].test(componentId)) {
+			entityComponentSignatures[entityId].set(componentId);
+			QueueSignatureChange(entities[i]);
+		}
+	}
 
-	Logger::debug("Component id = " + std::to_string(componentId) + " was added to entity id " + std::to_string(entityId));
+	LOG_DEBUG(ECS, "Component id = {} was added to {} entities", componentId, count);
 }
 
 template <typename TComponent>
@@ -281,9 +1287,25 @@ void Registry::RemoveComponent(Entity entity) {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
 
+	if (!IsAlive(entity)) {
+		LOG_ERROR(ECS, "Component id = {} wasn't removed, entity id {} generation {} isn't alive", componentId, entityId, entity.GetGeneration());
+		return;
+	}
+	if (!HasComponent<TComponent>(entity)) {
+		return;
+	}
+
+	if (storageMode == StorageMode::Archetypes) {
+		archetypes.Remove(entityId, componentId);
+	}
+	else {
+		GetPool<TComponent>()->Remove(entityId);
+	}
+
 	entityComponentSignatures[entityId].set(componentId, false);
+	QueueSignatureChange(entity);
 
-	Logger::debug("Component id = " + std::to_string(componentId) + " was removed from entity id " + std::to_string(entityId));
+	LOG_DEBUG(ECS, "Component id = {} was removed from entity id {}", componentId, entityId);
 }
 
 template <typename TComponent>
@@ -295,11 +1317,247 @@ bool Registry::HasComponent(Entity entity) const {
 }
 
 template<typename TComponent>
-TComponent& Registry::GetComponent(Entity entity) const {
+TComponent& Registry::GetComponent(Entity entity) {
+	// an entity without the component has no stamp to set
+	if (HasComponent<TComponent>(entity)) {
+		MarkChanged<TComponent>(entity);
+	}
+	return GetComponentUnmarked<TComponent>(entity);
+}
+
+template<typename TComponent>
+TComponent& Registry::GetComponentUnmarked(Entity entity) {
+	const int componentId = Component<TComponent>::GetId();
+	const int entityId = entity.GetId();
+	if (storageMode == StorageMode::Archetypes) {
+		return *static_cast<TComponent*>(archetypes.Get(entityId, componentId));
+	}
+	return GetPool<TComponent>()->Get(entityId);
+}
+
+template<typename TComponent>
+const TComponent& Registry::GetComponent(Entity entity) const {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-	return componentPool->Get(entityId);	
+	if (storageMode == StorageMode::Archetypes) {
+		return *static_cast<const TComponent*>(archetypes.Get(entityId, componentId));
+	}
+	return GetPool<TComponent>()->Get(entityId);
+}
+
+template <typename TComponent>
+uint32_t Registry::GetVersion() const {
+	if (storageMode == StorageMode::Archetypes) {
+		return archetypes.GetVersion(Component<TComponent>::GetId());
+	}
+	const Pool<TComponent>* componentPool = GetPool<TComponent>();
+	return componentPool ? componentPool->GetVersion() : 0;
+}
+
+template <typename TComponent, typename TFunction>
+void Registry::Patch(Entity entity, TFunction function) {
+	function(GetComponent<TComponent>(entity));
+}
+
+template <typename TComponent>
+void Registry::MarkChanged(Entity entity) {
+	MarkChanged<TComponent>(entity, NewVersion<TComponent>());
+}
+
+template <typename TComponent>
+uint32_t Registry::NewVersion() {
+	if (storageMode == StorageMode::Archetypes) {
+		return archetypes.NewVersion(Component<TComponent>::GetId());
+	}
+	return GetPool<TComponent>()->NewVersion();
+}
+
+template <typename TComponent>
+void Registry::MarkChanged(Entity entity, uint32_t version) {
+	if (storageMode == StorageMode::Archetypes) {
+		archetypes.SetStamp(entity.GetId(), Component<TComponent>::GetId(), version);
+		return;
+	}
+	GetPool<TComponent>()->SetStamp(entity.GetId(), version);
+}
+
+template <typename TComponent>
+ChangedView<TComponent> Registry::ViewChanged(uint32_t sinceVersion) {
+	const int componentId = Component<TComponent>::GetId();
+	std::vector<typename ChangedView<TComponent>::Block> blocks;
+
+	if (storageMode == StorageMode::Archetypes) {
+		for (Archetype* archetype : archetypes.GetArchetypes()) {
+			if (!archetype->signature.test(componentId)) {
+				continue;
+			}
+			for (auto& chunk : archetype->chunks) {
+				if (chunk->version.load(std::memory_order_relaxed) <= sinceVersion) {
+					continue;
+				}
+				blocks.push_back({
+					archetype->GetEntities(*chunk),
+					archetype->template GetColumn<TComponent>(*chunk, componentId),
+					archetype->GetStamps(*chunk, archetype->columns[componentId]),
+					chunk->count
+				});
+			}
+		}
+	}
+	else {
+		Pool<TComponent>* componentPool = GetPool<TComponent>();
+		// nothing changed since the version, the loop can be skipped completely
+		if (componentPool && componentPool->GetVersion() > sinceVersion) {
+			const size_t size = componentPool->GetSize();
+			const size_t blockSize = Pool<TComponent>::STAMP_BLOCK_SIZE;
+			for (size_t start = 0; start < size; start += blockSize) {
+				if (componentPool->GetBlockVersion(start / blockSize) <= sinceVersion) {
+					continue;
+				}
+				blocks.push_back({
+					componentPool->GetEntities() + start,
+					componentPool->GetData() + start,
+					componentPool->GetStamps() + start,
+					static_cast<int>(std::min(blockSize, size - start))
+				});
+			}
+		}
+	}
+
+	return ChangedView<TComponent>(this, entityGenerations.data(), sinceVersion, std::move(blocks));
+}
+
+template <typename TComponent>
+Pool<TComponent>* Registry::GetPool() const {
+	const int componentId = Component<TComponent>::GetId();
+	if (componentId >= componentPools.size()) {
+		return nullptr;
+	}
+	return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename ...TComponents>
+ComponentView<TComponents...> Registry::View() {
+	if (storageMode == StorageMode::Archetypes) {
+		Signature signature;
+		(signature.set(Component<TComponents>::GetId()), ...);
+
+		std::vector<typename ComponentView<TComponents...>::Block> blocks;
+		for (Archetype* archetype : archetypes.GetArchetypes()) {
+			if ((archetype->signature & signature) != signature) {
+				continue;
+			}
+			for (auto& chunk : archetype->chunks) {
+				blocks.push_back({ archetype, chunk.get() });
+			}
+		}
+		return ComponentView<TComponents...>(this, entityGenerations.data(), std::move(blocks));
+	}
+	return ComponentView<TComponents...>(this, entityGenerations.data(), GetPool<TComponents>()...);
+}
+
+template <typename ...TComponents>
+ComponentView<TComponents...>::ComponentView(Registry* registry, const uint16_t* entityGenerations, Pool<TComponents>* ...componentPools)
+	: registry(registry), entityGenerations(entityGenerations), useArchetypes(false), pools(componentPools...) {
+	// no entity can have all the components if one of the pools doesn't exist yet
+	if (((componentPools == nullptr) || ...)) {
+		return;
+	}
+	size_t smallestSize = SIZE_MAX;
+	auto pickDriver = [&](auto* pool) {
+		if (pool->GetSize() < smallestSize) {
+			smallestSize = pool->GetSize();
+			driverEntities = pool->GetEntities();
+			driverCount = static_cast<int>(pool->GetSize());
+		}
+	};
+	(pickDriver(componentPools), ...);
+}
+
+template <typename ...TComponents>
+ComponentView<TComponents...>::ComponentView(Registry* registry, const uint16_t* entityGenerations, std::vector<Block>&& blocks)
+	: registry(registry), entityGenerations(entityGenerations), useArchetypes(true), blocks(std::move(blocks)) {
+}
+
+template <typename ...TComponents>
+template <typename TFunction>
+void ComponentView<TComponents...>::ParallelEach(JobSystem& jobSystem, TFunction function) const {
+	const int grainSize = useArchetypes ? 1 : 1024;
+	// the system of the calling thread and the number of this ParallelEach in it, every range adds its first row
+	CommandBuffer& callerBuffer = registry->GetCommandBuffer();
+	callerBuffer.jobKey += static_cast<uint64_t>(1) << 32;
+	const uint64_t callKey = callerBuffer.jobKey & 0xFFFFFFFF00000000;
+	jobSystem.ParallelFor(GetRangeSize(), grainSize, [this, &function, callKey](int begin, int end) {
+		// a worker can run the range while it waits inside another job, so its key comes back afterwards
+		CommandBuffer& commandBuffer = registry->GetCommandBuffer();
+		const uint64_t previousKey = commandBuffer.jobKey;
+		commandBuffer.jobKey = callKey | (static_cast<uint64_t>(begin) + 1);
+		EachInRange(begin, end, function);
+		commandBuffer.jobKey = previousKey;
+	});
+}
+
+template <typename ...TComponents, typename TFunction>
+void Registry::ForEachChunk(TFunction function) {
+	Signature signature;
+	(signature.set(Component<TComponents>::GetId()), ...);
+
+	if (storageMode == StorageMode::Archetypes) {
+		for (Archetype* archetype : archetypes.GetArchetypes()) {
+			if ((archetype->signature & signature) != signature) {
+				continue;
+			}
+			for (auto& chunk : archetype->chunks) {
+				function(
+					chunk->count,
+					static_cast<const int*>(archetype->GetEntities(*chunk)),
+					archetype->template GetColumn<TComponents>(*chunk, Component<TComponents>::GetId())...
+				);
+			}
+		}
+		return;
+	}
+
+	// pools: every entity of the view is a block
+	View<TComponents...>().Each([&function](Entity entity, TComponents& ...components) {
+		const int entityId = entity.GetId();
+		function(1, &entityId, &components...);
+	});
+}
+
+template <typename T>
+ComponentInfo ComponentInfo::Create() {
+	ComponentInfo info;
+	info.size = sizeof(T);
+	info.alignment = alignof(T);
+	info.moveConstruct = [](void* destination, void* source) {
+		new (destination) T(std::move(*static_cast<T*>(source)));
+	};
+	info.destroy = [](void* component) {
+		static_cast<T*>(component)->~T();
+	};
+	return info;
+}
+
+template <typename T>
+void ArchetypeStorage::RegisterComponent(int componentId) {
+	if (componentId >= componentInfos.size()) {
+		componentInfos.resize(componentId + 1);
+	}
+	if (!componentInfos[componentId].moveConstruct) {
+		// one entity id, the aligned component and its stamp have to fit into a chunk
+		if (sizeof(int) + alignof(T) - 1 + sizeof(T) + alignof(uint32_t) - 1 + sizeof(uint32_t) > sizeof(Chunk::data)) {
+			LOG_CRITICAL(ECS, "The component id = {} ({} bytes) is too big for the chunks of the archetype storage", componentId, sizeof(T));
+			Logger::Flush();
+			std::abort();
+		}
+		componentInfos[componentId] = ComponentInfo::Create<T>();
+	}
+}
+
+template <typename TComponent, typename TFunction>
+void Entity::Patch(TFunction function) const {
+	registry->Patch<TComponent>(*this, function);
 }
 
 template <typename TComponent, typename ...TArgs>
@@ -322,3 +1580,40 @@ TComponent& Entity::GetComponent() const {
 	return registry->GetComponent<TComponent>(*this);
 }
 
+template<typename TComponent>
+const TComponent& Entity::ReadComponent() const {
+	const Registry& constRegistry = *registry;
+	return constRegistry.GetComponent<TComponent>(*this);
+}
+
+template <typename TComponent, typename ...TArgs>
+void CommandBuffer::AddComponent(Entity entity, TArgs&& ...args) {
+	Command* command = AddCommand(CommandType::AddComponent);
+	command->entity = entity;
+	command->component = new (Allocate(sizeof(TComponent), alignof(TComponent))) TComponent(std::forward<TArgs>(args)...);
+	command->addComponent = [](Registry& registry, Entity entity, void* component) {
+		registry.AddComponent<TComponent>(entity, std::move(*static_cast<TComponent*>(component)));
+	};
+	command->destroyComponent = [](void* component) {
+		static_cast<TComponent*>(component)->~TComponent();
+	};
+}
+
+template <typename TComponent, typename ...TArgs>
+void CommandBuffer::AddComponent(DeferredEntity entity, TArgs&& ...args) {
+	// played back right after the creation of the entity, no matter what the current sort key is
+	const uint32_t currentSortKey = sortKey;
+	sortKey = entity.sortKey;
+	AddComponent<TComponent>(Entity(0), std::forward<TArgs>(args)...);
+	commands.back()->deferredIndex = entity.index;
+	sortKey = currentSortKey;
+}
+
+template <typename TComponent>
+void CommandBuffer::RemoveComponent(Entity entity) {
+	Command* command = AddCommand(CommandType::RemoveComponent);
+	command->entity = entity;
+	command->removeComponent = [](Registry& registry, Entity entity) {
+		registry.RemoveComponent<TComponent>(entity);
+	};
+}
@@ -0,0 +1,29 @@
+#include "EventBus.h"
+#include "../Logger/Logger.h"
+
+int IEvent::nextId = 0;
+
+EventBus::EventBus() {
+	LOG_TRACE(Core, "EventBus constructor called!");
+}
+
+EventBus::~EventBus() {
+	LOG_TRACE(Core, "EventBus destructor called!");
+}
+
+void EventBus::Dispatch() {
+	// by index, a subscriber may use a new event type
+	for (size_t i = 0; i < queues.size(); i++) {
+		if (queues[i]) {
+			queues[i]->Dispatch();
+		}
+	}
+}
+
+void EventBus::Clear() {
+	for (auto& queue : queues) {
+		if (queue) {
+			queue->Clear();
+		}
+	}
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include "../ECS/ECS.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Event
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// parent for all the events
+struct IEvent {
+protected:
+	static int nextId;
+};
+
+// for the assignment of an unique id to an event type (like Component<T>)
+template <typename T>
+class Event : public IEvent {
+public:
+	// returns the ID of Event<T>
+	static int GetId() {
+		static int id = nextId++;
+		return id;
+	}
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EventQueue
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+class IEventQueue {
+public:
+	virtual ~IEventQueue() = default;
+
+	// sends the queued events to the subscribers
+	virtual void Dispatch() = 0;
+	virtual void Clear() = 0;
+};
+
+// subscribers and queued events of one event type
+// a subscriber is an object pointer plus a function pointer to a thunk which calls the member function,
+// so subscribing doesn't allocate a std::function and calling it is one indirect call
+template <typename TEvent>
+class EventQueue : public IEventQueue {
+public:
+	struct Subscriber {
+		void* owner;
+		void (*callback)(void* owner, const TEvent& event); // one event
+		void (*batchCallback)(void* owner, Span<const TEvent> events); // all the events of a dispatch
+	};
+
+private:
+	std::vector<Subscriber> subscribers;
+	std::vector<TEvent> events; // queued for the next Dispatch()
+	std::vector<TEvent> dispatching; // swapped with events, so subscribers can queue events for the next dispatch
+	int dispatchDepth = 0;
+	bool hasRemovedSubscribers = false;
+
+	// unsubscribing while the subscribers get called only clears the entry, the list gets compacted afterwards
+	void RemoveClearedSubscribers() {
+		if (dispatchDepth > 0 || !hasRemovedSubscribers) {
+			return;
+		}
+		subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [](const Subscriber& subscriber) {
+			return subscriber.owner == nullptr && subscriber.callback == nullptr && subscriber.batchCallback == nullptr;
+		}), subscribers.end());
+		hasRemovedSubscribers = false;
+	}
+
+public:
+	void Subscribe(const Subscriber& subscriber) {
+		subscribers.push_back(subscriber);
+	}
+
+	void Unsubscribe(void* owner) {
+		// the free functions have no owner, they stay subscribed
+		if (!owner) {
+			return;
+		}
+		for (Subscriber& subscriber : subscribers) {
+			if (subscriber.owner == owner) {
+				subscriber = { nullptr, nullptr, nullptr };
+				hasRemovedSubscribers = true;
+			}
+		}
+		RemoveClearedSubscribers();
+	}
+
+	template <typename ...TArgs> void Enqueue(TArgs&& ...args) {
+		events.emplace_back(std::forward<TArgs>(args)...);
+	}
+
+	// calls the subscribers right away
+	void Emit(const TEvent& event) {
+		dispatchDepth++;
+		// by index, a subscriber may subscribe others
+		for (size_t i = 0; i < subscribers.size(); i++) {
+			const Subscriber subscriber = subscribers[i];
+			if (subscriber.callback) {
+				subscriber.callback(subscriber.owner, event);
+			}
+			else if (subscriber.batchCallback) {
+				subscriber.batchCallback(subscriber.owner, Span<const TEvent>(&event, 1));
+			}
+		}
+		dispatchDepth--;
+		RemoveClearedSubscribers();
+	}
+
+	// every subscriber gets all the events in a row (one batch), events queued meanwhile wait for the next dispatch
+	void Dispatch() override {
+		if (events.empty() || dispatchDepth > 0) {
+			return;
+		}
+		dispatching.swap(events);
+		dispatchDepth++;
+		const Span<const TEvent> batch(dispatching);
+		for (size_t i = 0; i < subscribers.size(); i++) {
+			const Subscriber subscriber = subscribers[i];
+			if (subscriber.batchCallback) {
+				subscriber.batchCallback(subscriber.owner, batch);
+			}
+			else if (subscriber.callback) {
+				for (const TEvent& event : batch) {
+					subscriber.callback(subscriber.owner, event);
+				}
+			}
+		}
+		dispatchDepth--;
+		// keeps the memory for the next frame
+		dispatching.clear();
+		RemoveClearedSubscribers();
+	}
+
+	void Clear() override {
+		events.clear();
+	}
+
+	size_t GetNumQueuedEvents() const {
+		return events.size();
+	}
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EventBus
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// typed events between systems without knowing each other
+// immediate: Emit<T>(...) calls the subscribers right away
+// deferred: Enqueue<T>(...) appends the event to the contiguous queue of its type,
+// Dispatch() (the sync point, once per frame) hands every queue to its subscribers in one batch
+// usage: eventBus.Subscribe<KeyPressedEvent, PlayerSystem, &PlayerSystem::OnKeyPressed>(this);
+// only for the main thread, systems on the job system have to queue their events on their own
+class EventBus {
+private:
+	// [vector index = event type id]
+	std::vector<std::unique_ptr<IEventQueue>> queues;
+
+	template <typename TEvent> EventQueue<TEvent>& GetQueue();
+
+public:
+	EventBus();
+	~EventBus();
+	EventBus(const EventBus&) = delete;
+	EventBus& operator =(const EventBus&) = delete;
+
+	// callback for every event: void TOwner::Callback(const TEvent& event)
+	template <typename TEvent, typename TOwner, void (TOwner::*Callback)(const TEvent&)> void Subscribe(TOwner* owner);
+	// callback for all the events of a dispatch at once: void TOwner::Callback(Span<const TEvent> events)
+	template <typename TEvent, typename TOwner, void (TOwner::*Callback)(Span<const TEvent>)> void SubscribeBatch(TOwner* owner);
+	// free function callback: void Callback(const TEvent& event)
+	template <typename TEvent, void (*Callback)(const TEvent&)> void Subscribe();
+	// removes every callback of the owner for events of type TEvent
+	template <typename TEvent, typename TOwner> void Unsubscribe(TOwner* owner);
+
+	// calls the subscribers now with an event constructed from the arguments TArgs
+	template <typename TEvent, typename ...TArgs> void Emit(TArgs&& ...args);
+	// queues an event constructed from the arguments TArgs for the next Dispatch()
+	template <typename TEvent, typename ...TArgs> void Enqueue(TArgs&& ...args);
+
+	// sends the queued events of every type to the subscribers (in the order the event types were first used)
+	void Dispatch();
+	// drops the queued events
+	void Clear();
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Implementation of template functions
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename TEvent>
+EventQueue<TEvent>& EventBus::GetQueue() {
+	const int eventId = Event<TEvent>::GetId();
+	if (eventId >= queues.size()) {
+		queues.resize(eventId + 1);
+	}
+	if (!queues[eventId]) {
+		queues[eventId] = std::make_unique<EventQueue<TEvent>>();
+	}
+	return *static_cast<EventQueue<TEvent>*>(queues[eventId].get());
+}
+
+template <typename TEvent, typename TOwner, void (TOwner::*Callback)(const TEvent&)>
+void EventBus::Subscribe(TOwner* owner) {
+	GetQueue<TEvent>().Subscribe({
+		owner,
+		[](void* owner, const TEvent& event) {
+			(static_cast<TOwner*>(owner)->*Callback)(event);
+		},
+		nullptr
+	});
+}
+
+template <typename TEvent, typename TOwner, void (TOwner::*Callback)(Span<const TEvent>)>
+void EventBus::SubscribeBatch(TOwner* owner) {
+	GetQueue<TEvent>().Subscribe({
+		owner,
+		nullptr,
+		[](void* owner, Span<const TEvent> events) {
+			(static_cast<TOwner*>(owner)->*Callback)(events);
+		}
+	});
+}
+
+template <typename TEvent, void (*Callback)(const TEvent&)>
+void EventBus::Subscribe() {
+	// no owner, the function is a template argument of the callback
+	GetQueue<TEvent>().Subscribe({
+		nullptr,
+		[](void*, const TEvent& event) {
+			Callback(event);
+		},
+		nullptr
+	});
+}
+
+template <typename TEvent, typename TOwner>
+void EventBus::Unsubscribe(TOwner* owner) {
+	GetQueue<TEvent>().Unsubscribe(owner);
+}
+
+template <typename TEvent, typename ...TArgs>
+void EventBus::Emit(TArgs&& ...args) {
+	GetQueue<TEvent>().Emit(TEvent(std::forward<TArgs>(args)...));
+}
+
+template <typename TEvent, typename ...TArgs>
+void EventBus::Enqueue(TArgs&& ...args) {
+	GetQueue<TEvent>().Enqueue(std::forward<TArgs>(args)...);
+}
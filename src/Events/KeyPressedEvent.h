@@ -0,0 +1,14 @@
+#pragma once
+
+#include <SDL.h>
+
+// a key went down, queued by Game::ProcessInput()
+struct KeyPressedEvent {
+	SDL_Keycode key;
+	Uint16 modifiers;
+
+	KeyPressedEvent(SDL_Keycode key, Uint16 modifiers = KMOD_NONE) {
+		this->key = key;
+		this->modifiers = modifiers;
+	}
+};
\ No newline at end of file
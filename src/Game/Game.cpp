@@ -2,20 +2,34 @@
 #include "../ECS/ECS.h"
 #include <SDL_image.h>
 #include <glm/glm.hpp>
-#include <fstream>
+#include <algorithm>
+#include <cmath>
 #include "../Logger/Logger.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
+#include "../Components/CameraComponent.h"
+#include "../Components/AnimationComponent.h"
 #include "../Systems/MovementSystem.h"
 #include "../Systems/RenderingSystem.h"
+#include "../Systems/HierarchySystem.h"
+#include "../Systems/CameraSystem.h"
+#include "../Systems/AnimationSystem.h"
+#include "../Systems/InterpolationSystem.h"
+#include "../Events/KeyPressedEvent.h"
+#include "../Tilemap/TilemapFile.h"
 
 Game::Game() {
 	Logger::set_level(Logger::level::trace);
-	Logger::trace("Game constructor called!");
+	LOG_TRACE(Core, "Game constructor called!");
 	isRunning = false;
 	registry = std::make_unique<Registry>();
 	assetHandler = std::make_unique<AssetHandler>();
+	jobSystem = std::make_unique<JobSystem>();
+	eventBus = std::make_unique<EventBus>();
+	renderBackend = std::make_unique<RenderBackend>();
+	animationLibrary = std::make_unique<AnimationLibrary>();
+	registry->SetJobSystem(jobSystem.get());
 	window = NULL;
 	renderer = NULL;
 	windowWidth = 0;
@@ -23,13 +37,37 @@ Game::Game() {
 }
 
 Game::~Game(){
-	Logger::trace("Game destructor called!");
+	LOG_TRACE(Core, "Game destructor called!");
 }
 
-void Game::Initialize(){
+void Game::Initialize(const GameOptions& options){
+	SetSimulationRate(options.simulationRate);
+	numFrames = options.numFrames;
+	isHeadless = options.isHeadless;
+	if (isHeadless) {
+		// no video and no audio, the timer and the event queue (SDL_QUIT on ctrl+c) work without them
+		if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0) {
+			LOG_CRITICAL(Core, "Error initializing SDL: {}", SDL_GetError());
+			return;
+		}
+		windowWidth = options.headlessWidth;
+		windowHeight = options.headlessHeight;
+		if (options.useSoftwareRenderer) {
+			headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_RGBA32);
+			renderer = headlessSurface ? SDL_CreateSoftwareRenderer(headlessSurface) : NULL;
+			if (!renderer) {
+				LOG_CRITICAL(Render, "Error creating the software renderer: {}", SDL_GetError());
+				return;
+			}
+		}
+		LOG_INFO(Core, "Running headless ({}x{}, {})", windowWidth, windowHeight, renderer ? "software renderer" : "no renderer");
+		isRunning = true;
+		return;
+	}
+
 	//// Rendering init start
 	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
-		Logger::critical("Error initializing rendering.");
+		LOG_CRITICAL(Render, "Error initializing rendering.");
 		return;
 	}
 	SDL_DisplayMode displayMode;
@@ -45,7 +83,7 @@ void Game::Initialize(){
 		0 | SDL_WINDOW_BORDERLESS // SDL_WINDOW_RESIZABLE // 
 	);
 	if (!window) {
-		spdlog::critical("Error creating window.");
+		LOG_CRITICAL(Render, "Error creating window: {}", SDL_GetError());
 		return;
 	}
 
@@ -55,7 +93,7 @@ void Game::Initialize(){
 		SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
 	);
 	if (!renderer) {
-		spdlog::critical("Error creating renderer");
+		LOG_CRITICAL(Render, "Error creating renderer: {}", SDL_GetError());
 		return;
 	}
 	SDL_RenderSetLogicalSize(renderer, displayMode.w, displayMode.h);
@@ -76,6 +114,18 @@ void Game::ProcessInput() {
 				if (sdlEvent.key.keysym.sym == SDLK_ESCAPE) {
 					isRunning = false;
 				}
+				eventBus->Enqueue<KeyPressedEvent>(sdlEvent.key.keysym.sym, sdlEvent.key.keysym.mod);
+				break;
+			case SDL_RENDER_TARGETS_RESET:
+				// the baked tilemap chunks are gone, the textures are still there
+				renderBackend->Invalidate();
+				break;
+			case SDL_RENDER_DEVICE_RESET:
+				// every texture is gone, the chunk textures get created again when they are drawn
+				renderBackend->Clear();
+				assetHandler->ReloadTextures(renderer);
+				// the frame waiting for the RenderBackend points to the old textures, the simulation thread is idle here
+				Render();
 				break;
 		}
 	}
@@ -84,99 +134,215 @@ void Game::ProcessInput() {
 void Game::LoadLevel(int level) {
 	registry->AddSystem<MovementSystem>();
 	registry->AddSystem<RenderingSystem>();
+	registry->AddSystem<HierarchySystem>();
+	registry->AddSystem<CameraSystem>();
+	registry->AddSystem<AnimationSystem>(*animationLibrary);
+	registry->AddSystem<InterpolationSystem>();
 
-	assetHandler->AddTexture(renderer, "tank-right", "./assets/images/tank-panther-right.png");
-	assetHandler->AddTexture(renderer, "truck-down", "./assets/images/truck-ford-down.png");
-
-	// TODO: I dont like this part loading the tilemap should be seperated and abstracted
-	// TODO: into a Tilemap class in ECS.h so the user doesn't has to
-	// TODO: pase it manualy and the AssetHandler should have e List for that
-	assetHandler->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
-
-	int tileSize = 32;
-	double tileScale = 2.0;
-	int mapNumCols = 25;
-	int mapNumRows = 20;
-
-	std::fstream mapFile;
-	mapFile.open("./assets/tilemaps/jungle.map");
-
-	for (int y = 0; y < mapNumRows; y++) {
-		for (int x = 0; x < mapNumCols; x++) {
-			char ch;
-			mapFile.get(ch);
-			int srcRectY = std::atoi(&ch) * tileSize;
-			mapFile.get(ch);
-			int srcRectX = std::atoi(&ch) * tileSize;
-			mapFile.ignore();
-
-			// TODO: an Entity is really unefficient for this case instead make a Tile class in ECS.h
-			Entity tile = registry->CreateEntity();
-			tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)), glm::vec2(tileScale, tileScale), 0.0);
-			tile.AddComponent<SpriteComponent>("tilemap-image", tileSize, tileSize, srcRectX, srcRectY);
-		}
-	}
+	registry->GetSystem<MovementSystem>().SetParallel(true);
+	// gameplay systems which run in every step of Update(), the RenderingSystem runs in Render()
+	// first, so the transforms before the step are kept for the interpolation
+	registry->ScheduleSystem<InterpolationSystem>();
+	registry->ScheduleSystem<MovementSystem>();
+	// shares no component with the MovementSystem, so both run at the same time
+	registry->ScheduleSystem<AnimationSystem>();
+	// after the MovementSystem (both write transforms), so attached entities follow in the same frame
+	registry->ScheduleSystem<HierarchySystem>();
+	// reads the transforms, so it runs after the systems which move the targets
+	registry->ScheduleSystem<CameraSystem>();
+	registry->GetSystem<CameraSystem>().SubscribeToEvents(*eventBus);
 
-	mapFile.close();
+	// all the sprite images in one atlas, packed on the first start and whenever an image changes
+	assetHandler->AddAtlasImages("./assets/images");
+	assetHandler->BuildAtlas(renderer, "./assets/atlas/sprites");
 
+	// chopper-spritesheet.png: two frames per direction, one direction per row
+	animationLibrary->AddStripClip("chopper-up", 0, 0, 32, 32, 2, 0.05f);
+	animationLibrary->AddStripClip("chopper-right", 0, 32, 32, 32, 2, 0.05f);
+	animationLibrary->AddStripClip("chopper-down", 0, 64, 32, 32, 2, 0.05f);
+	animationLibrary->AddStripClip("chopper-left", 0, 96, 32, 32, 2, 0.05f);
+
+	// the text map is compiled into the binary map when it changed, the binary map gets mapped into memory
+	const std::string mapSource = "./assets/tilemaps/jungle.map";
+	const std::string mapFile = "./assets/tilemaps/jungle.jmap";
+	if (TilemapFile::IsOutdated(mapSource, mapFile)) {
+		TilemapFile::Compile(mapSource, mapFile);
+	}
+	// the tiles are no entities, the TilemapRenderer draws them in chunks
+	tilemap = TilemapFile::Load(mapFile);
+	SDL_Rect mapBounds = { 0, 0, 0, 0 };
+	if (tilemap) {
+		assetHandler->AddTexture(renderer, tilemap->GetTilesetId(), tilemap->GetTilesetPath());
+		mapBounds.w = static_cast<int>(tilemap->GetWidth() * tilemap->GetWorldTileSize());
+		mapBounds.h = static_cast<int>(tilemap->GetHeight() * tilemap->GetWorldTileSize());
+	}
 
 	Entity tank = registry->CreateEntity();
 	tank.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(2.0, 2.0), 0.0);
 	tank.AddComponent<RigidBodyComponent>(glm::vec2(80.0, 0.0));
-	tank.AddComponent<SpriteComponent>("tank-right", 32, 32);
+	tank.AddComponent<SpriteComponent>(assetHandler->CreateSprite("tank-panther-right", 32, 32));
 
 	Entity truck = registry->CreateEntity();
 	truck.AddComponent<TransformComponent>(glm::vec2(50.0, 100.0), glm::vec2(2.0, 2.0), 0.0);
 	truck.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 100.0));
-	truck.AddComponent<SpriteComponent>("truck-down", 32, 32);
+	truck.AddComponent<SpriteComponent>(assetHandler->CreateSprite("truck-ford-down", 32, 32));
+
+	// flies above the vehicles (layer 1)
+	Entity chopper = registry->CreateEntity();
+	chopper.AddComponent<TransformComponent>(glm::vec2(10.0, 200.0), glm::vec2(2.0, 2.0), 0.0);
+	chopper.AddComponent<RigidBodyComponent>(glm::vec2(60.0, 0.0));
+	chopper.AddComponent<SpriteComponent>(assetHandler->CreateSprite("chopper-spritesheet", 32, 32, 0, 32, 1));
+	chopper.AddComponent<AnimationComponent>(animationLibrary->GetClipId("chopper-right"));
+
+	// follows the tank and stops at the edges of the map
+	Entity camera = registry->CreateEntity();
+	camera.AddComponent<CameraComponent>(windowWidth, windowHeight, 1.0f, mapBounds);
+	camera.GetComponent<CameraComponent>().Follow(tank, 5.0f);
 }
 
 void Game::Setup() {
 	LoadLevel(1);
 }
 
+void Game::SetSimulationRate(int stepsPerSecond) {
+	stepTime = 1.0 / std::max(stepsPerSecond, 1);
+}
+
+int Game::GetSimulationRate() const {
+	return static_cast<int>(std::lround(1.0 / stepTime));
+}
+
+// runs as many fixed steps as the time since the last frame holds, the rest waits for the next frame
 void Game::Update() {
-	// limit FPS
-	if (MAX_FPS != NULL) {
-		int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - msPrevFrame);
-		if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME) {
-			SDL_Delay(timeToWait);
+	const Uint64 counter = SDL_GetPerformanceCounter();
+	const double frameTime = static_cast<double>(counter - prevFrameCounter) / SDL_GetPerformanceFrequency();
+	prevFrameCounter = counter;
+	// headless frames aren't shown to anybody, so each one is one step and the runs are the same on every machine
+	accumulatedTime += isHeadless ? stepTime : std::min(frameTime, MAX_FRAME_TIME);
+
+	int steps = 0;
+	while (accumulatedTime >= stepTime) {
+		if (steps == MAX_STEPS_PER_FRAME) {
+			LOG_DEBUG(Core, "The simulation is {:.1f} ms behind, skipping it", accumulatedTime * 1000.0);
+			accumulatedTime = std::fmod(accumulatedTime, stepTime);
+			break;
 		}
-	}
 
-	double deltaTime = (SDL_GetTicks() - msPrevFrame) / 1000.0;
+		// sync point: the events (input etc.) reach their subscribers before the systems run
+		eventBus->Dispatch();
 
-	msPrevFrame = SDL_GetTicks();
+		registry->RunSystems(stepTime);
 
-	registry->GetSystem<MovementSystem>().Update(deltaTime);
+		registry->Update();
 
-	registry->Update();
+		accumulatedTime -= stepTime;
+		steps++;
+	}
+
+	interpolationAlpha = static_cast<float>(accumulatedTime / stepTime);
 }
 
+// the render frontend: records the frame for the RenderBackend, no SDL_Renderer calls here
 void Game::Render() {
-	//// Render update start
-	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
-	SDL_RenderClear(renderer);
-
-	registry->GetSystem<RenderingSystem>().Update(renderer, assetHandler);
+	RenderCommandList& commands = renderCommands[recordingCommands];
+	commands.Reset();
+	commands.AddClear({ 21, 21, 21, 255 });
 
-	SDL_RenderPresent(renderer);
-	//// Render update stop
+	// the tilemap below the sprites, both from the same camera
+	RenderingSystem& renderingSystem = registry->GetSystem<RenderingSystem>();
+	const CameraComponent camera = renderingSystem.GetCamera(windowWidth, windowHeight, interpolationAlpha);
+	if (tilemap) {
+		const RenderView view = { camera.position.x, camera.position.y, camera.zoom, camera.viewportWidth, camera.viewportHeight };
+		commands.AddTilemap(*tilemap, assetHandler->GetTexture(tilemap->GetTilesetId()), view);
+	}
+	renderingSystem.Update(commands, camera, assetHandler, interpolationAlpha);
 }
 
 void Game::Run() {
 	Setup();
+	simulationThread = std::make_unique<WorkerThread>();
+
+	// the first frame simulates one step, so the camera already found its target
+	prevFrameCounter = SDL_GetPerformanceCounter();
+	accumulatedTime = stepTime;
+	Update();
+	Render();
+
+	const Uint64 frequency = SDL_GetPerformanceFrequency();
+	std::vector<double> frameMs;
+	frameMs.reserve(numFrames);
+	double totalSimulationMs = 0.0;
+	double totalSubmitMs = 0.0;
 	while (isRunning) {
+		const Uint64 frameStart = SDL_GetPerformanceCounter();
+		// the input reaches the simulation between two frames, while nothing else runs
 		ProcessInput();
-		Update();
-		Render();
+
+		// frame N gets drawn here while the simulation thread updates and records frame N + 1
+		const RenderCommandList& frame = renderCommands[recordingCommands];
+		recordingCommands = 1 - recordingCommands;
+		simulationThread->Run([this, frequency]() {
+			const Uint64 start = SDL_GetPerformanceCounter();
+			Update();
+			Render();
+			simulationMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+		});
+		const Uint64 submitStart = SDL_GetPerformanceCounter();
+		// headless without a renderer the frames get recorded but not drawn
+		if (renderer) {
+			renderBackend->Submit(renderer, frame);
+		}
+		totalSubmitMs += (SDL_GetPerformanceCounter() - submitStart) * 1000.0 / frequency;
+		simulationThread->Wait();
+		totalSimulationMs += simulationMs;
+
+		if (numFrames > 0) {
+			frameMs.push_back((SDL_GetPerformanceCounter() - frameStart) * 1000.0 / frequency);
+			if (static_cast<int>(frameMs.size()) == numFrames) {
+				isRunning = false;
+			}
+		}
+	}
+
+	simulationThread.reset();
+
+	if (!frameMs.empty()) {
+		LogFrameStats(frameMs, totalSimulationMs, totalSubmitMs);
+	}
+}
+
+void Game::LogFrameStats(const std::vector<double>& frameMs, double totalSimulationMs, double totalSubmitMs) const {
+	std::vector<double> sorted = frameMs;
+	std::sort(sorted.begin(), sorted.end());
+	double totalMs = 0.0;
+	for (double ms : sorted) {
+		totalMs += ms;
+	}
+	const size_t count = sorted.size();
+	LOG_INFO(Core, "{} frames in {:.1f} ms ({:.0f} frames per second), {:.1f} s simulated at {} steps per second",
+		count, totalMs, count * 1000.0 / totalMs, count * stepTime, GetSimulationRate());
+	LOG_INFO(Core, "Frame: {:.3f} ms average, {:.3f} ms min, {:.3f} ms median, {:.3f} ms 99th percentile, {:.3f} ms max",
+		totalMs / count, sorted.front(), sorted[count / 2], sorted[std::min(count - 1, count * 99 / 100)], sorted.back());
+	LOG_INFO(Core, "Update and record: {:.3f} ms, submit: {:.3f} ms per frame (both at the same time)",
+		totalSimulationMs / count, totalSubmitMs / count);
+	if (renderer) {
+		LOG_INFO(Core, "Last frame: {} draw calls, {} sprites", renderBackend->GetNumDrawCalls(), renderBackend->GetNumSprites());
 	}
 }
 
 void Game::Destroy(){
 	//// Rendere quit start
-	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	// the chunk textures belong to the renderer
+	renderBackend->Clear();
+	if (renderer) {
+		SDL_DestroyRenderer(renderer);
+	}
+	if (window) {
+		SDL_DestroyWindow(window);
+	}
+	if (headlessSurface) {
+		SDL_FreeSurface(headlessSurface);
+	}
 	//// Rendere quit stop
 	SDL_Quit();
 }
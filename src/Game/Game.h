@@ -1,28 +1,75 @@
 #pragma 
 #include <memory>
+#include <vector>
 #include <SDL.h>
 #include "../ECS/ECS.h"
 #include <glm/glm.hpp>
 #include "../AssetManager/AssetHandler.h"
+#include "../Jobs/JobSystem.h"
+#include "../EventBus/EventBus.h"
+#include "../Tilemap/Tilemap.h"
+#include "../Renderer/RenderCommandList.h"
+#include "../Renderer/RenderBackend.h"
+#include "../Jobs/WorkerThread.h"
+#include "../Animation/AnimationLibrary.h"
 
-const int MAX_FPS = 60;
-const int MILLISECS_PER_FRAME = 1000 / MAX_FPS;
+// the simulation runs in fixed steps, independent of the frame rate (vsync paces the frames)
+const int SIMULATION_RATE = 60; // steps per second unless SetSimulationRate() says otherwise
+// a slow frame drops the time it can't catch up with, instead of needing even more steps in the next frame
+const int MAX_STEPS_PER_FRAME = 5;
+const double MAX_FRAME_TIME = 0.25; // longer frames (a breakpoint, dragging the window) count as this long
+
+// how Game::Initialize() sets up SDL and how long Game::Run() runs, Main.cpp fills it from the command line
+struct GameOptions {
+	// no window, no audio and no vsync, for servers, the build farm and benchmarks
+	// every frame runs exactly one simulation step, as fast as it can
+	bool isHeadless = false;
+	// headless: draws with the software renderer into a surface in memory, otherwise nothing gets drawn
+	// (the frames still get recorded, only the RenderBackend is skipped)
+	bool useSoftwareRenderer = false;
+	int headlessWidth = 1280;
+	int headlessHeight = 720;
+	// stops after so many frames and logs the frame times, 0 = runs until the window gets closed
+	int numFrames = 0;
+	int simulationRate = SIMULATION_RATE;
+};
 
 class Game {
 	private:
 		bool isRunning;
-		Uint32 msPrevFrame = 0;
+		bool isHeadless = false;
+		int numFrames = 0;
+		Uint64 prevFrameCounter = 0;
+		double stepTime = 1.0 / SIMULATION_RATE;
+		double accumulatedTime = 0.0; // not simulated yet, less than a step after each Update()
+		float interpolationAlpha = 0.0f; // accumulatedTime in steps, where Render() draws between the last two steps
 		SDL_Window* window;
 		SDL_Renderer* renderer;
+		SDL_Surface* headlessSurface = nullptr; // target of the software renderer in headless mode
 
 		std::unique_ptr<Registry> registry;
 		std::unique_ptr<AssetHandler> assetHandler;
+		std::unique_ptr<JobSystem> jobSystem;
+		std::unique_ptr<EventBus> eventBus;
+		// only changed between frames, the RenderBackend draws it while the next frame gets simulated
+		std::unique_ptr<Tilemap> tilemap;
+		std::unique_ptr<RenderBackend> renderBackend;
+		// Update() and Render() of frame N + 1 run there while the main thread draws frame N
+		std::unique_ptr<WorkerThread> simulationThread;
+		// Render() records into one list while the RenderBackend draws the other one
+		RenderCommandList renderCommands[2];
+		int recordingCommands = 0;
+		std::unique_ptr<AnimationLibrary> animationLibrary;
+
+		// written by the simulation thread, read after it finished the frame
+		double simulationMs = 0.0;
+		void LogFrameStats(const std::vector<double>& frameMs, double totalSimulationMs, double totalSubmitMs) const;
 
 	public:
 		Game(void);
 		~Game(void);
 		// TODO init takes title width heigth etc.
-		void Initialize(void);
+		void Initialize(const GameOptions& options = GameOptions());
 		void Run(void);
 		void LoadLevel(int level);
 		void Setup(void);
@@ -30,6 +77,8 @@ class Game {
 		void Update(void);
 		void Render(void);
 		void Destroy(void);
+		void SetSimulationRate(int stepsPerSecond);
+		int GetSimulationRate(void) const;
 
 		int windowWidth;
 		int windowHeight;
@@ -0,0 +1,164 @@
+#include "JobSystem.h"
+#include "../Logger/Logger.h"
+
+namespace {
+	// which job system and worker the current thread belongs to
+	thread_local const JobSystem* currentJobSystem = nullptr;
+	thread_local int currentWorkerIndex = -1;
+}
+
+JobSystem::JobSystem(int numThreads) : isRunning(true), queuedJobs(0) {
+	if (numThreads <= 0) {
+		numThreads = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	if (numThreads <= 0) {
+		numThreads = 1;
+	}
+
+	// one more deque for the threads outside the job system
+	for (int i = 0; i <= numThreads; i++) {
+		workers.push_back(std::make_unique<Worker>());
+	}
+
+	currentJobSystem = this;
+	currentWorkerIndex = 0;
+	for (int i = 1; i < numThreads; i++) {
+		threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+
+	LOG_TRACE(Core, "JobSystem constructor called with {} workers!", numThreads);
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		isRunning = false;
+	}
+	wakeUp.notify_all();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	if (currentJobSystem == this) {
+		currentJobSystem = nullptr;
+		currentWorkerIndex = -1;
+	}
+	LOG_TRACE(Core, "JobSystem destructor called!");
+}
+
+int JobSystem::GetNumWorkers() const {
+	return static_cast<int>(workers.size()) - 1;
+}
+
+int JobSystem::GetWorkerIndex() const {
+	return currentJobSystem == this ? currentWorkerIndex : -1;
+}
+
+int JobSystem::GetQueueIndex() const {
+	const int workerIndex = GetWorkerIndex();
+	return workerIndex < 0 ? GetNumWorkers() : workerIndex;
+}
+
+void JobSystem::WorkerLoop(int workerIndex) {
+	currentJobSystem = this;
+	currentWorkerIndex = workerIndex;
+
+	while (true) {
+		Job job;
+		if (PopOrSteal(job)) {
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this] { return !isRunning || queuedJobs > 0; });
+		if (!isRunning) {
+			return;
+		}
+	}
+}
+
+void JobSystem::Push(const Job& job) {
+	// threads which don't belong to the job system put their jobs into the extra deque, not into the one of a busy worker
+	Worker& worker = *workers[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.push_back(job);
+	}
+	queuedJobs++;
+}
+
+bool JobSystem::PopOrSteal(Job& job) {
+	const int start = GetQueueIndex();
+	const int numQueues = static_cast<int>(workers.size());
+
+	// own deque: newest job first (its data is still warm in the cache)
+	if (GetWorkerIndex() >= 0) {
+		Worker& worker = *workers[start];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.jobs.empty()) {
+			job = worker.jobs.back();
+			worker.jobs.pop_back();
+			queuedJobs--;
+			return true;
+		}
+	}
+
+	// other deques: oldest job first (usually the biggest remaining piece of work)
+	for (int i = 1; i <= numQueues; i++) {
+		Worker& victim = *workers[(start + i) % numQueues];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = victim.jobs.front();
+			victim.jobs.pop_front();
+			queuedJobs--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::Execute(const Job& job) {
+	job.function(job.data, job.begin, job.end);
+	job.unfinishedJobs->fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::ParallelFor(int count, int grainSize, void (*function)(void* data, int begin, int end), void* data) {
+	if (count <= 0) {
+		return;
+	}
+	if (grainSize <= 0) {
+		grainSize = 1;
+	}
+
+	// not worth waking anybody up
+	if (count <= grainSize || GetNumWorkers() == 1) {
+		function(data, 0, count);
+		return;
+	}
+
+	std::atomic<int> unfinishedJobs((count + grainSize - 1) / grainSize);
+	for (int begin = 0; begin < count; begin += grainSize) {
+		Job job;
+		job.function = function;
+		job.data = data;
+		job.begin = begin;
+		job.end = begin + grainSize < count ? begin + grainSize : count;
+		job.unfinishedJobs = &unfinishedJobs;
+		Push(job);
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeUp.notify_all();
+
+	// help until our jobs are done, this can also run jobs of other ParallelFor calls (nested ones)
+	while (unfinishedJobs.load(std::memory_order_acquire) > 0) {
+		Job job;
+		if (PopOrSteal(job)) {
+			Execute(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
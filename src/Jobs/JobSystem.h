@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+// a piece of work for the job system, a range [begin, end) of a ParallelFor
+struct Job {
+	void (*function)(void* data, int begin, int end) = nullptr;
+	void* data = nullptr;
+	int begin = 0;
+	int end = 0;
+	std::atomic<int>* unfinishedJobs = nullptr; // counter of the ParallelFor which waits for this job
+};
+
+// thread pool with one worker per core, every worker has its own deque of jobs
+// a worker takes the newest job of its own deque and steals the oldest job of another deque when it has nothing to do
+// the thread which calls ParallelFor works on the jobs as well until all of them are done
+// threads which don't belong to the job system (the simulation thread) share one extra deque, the workers steal from it
+class JobSystem {
+private:
+	struct Worker {
+		std::deque<Job> jobs;
+		std::mutex mutex;
+	};
+
+	// [vector index = worker index], worker 0 is the thread which created the job system
+	// the last deque (index GetNumWorkers()) gets the jobs of the threads outside the job system
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+
+	std::atomic<bool> isRunning;
+	std::atomic<int> queuedJobs;
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	void WorkerLoop(int workerIndex);
+	void Push(const Job& job);
+	bool PopOrSteal(Job& job);
+	void Execute(const Job& job);
+	void ParallelFor(int count, int grainSize, void (*function)(void* data, int begin, int end), void* data);
+
+public:
+	// numThreads = 0 uses one thread per core (including the calling thread)
+	JobSystem(int numThreads = 0);
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator =(const JobSystem&) = delete;
+
+	int GetNumWorkers() const;
+	// index of the worker which runs the current thread, -1 if the thread doesn't belong to the job system
+	int GetWorkerIndex() const;
+	// GetWorkerIndex() or GetNumWorkers() for the threads outside the job system, an index for per thread data
+	int GetQueueIndex() const;
+
+	// splits [0, count) into ranges of grainSize and calls function(begin, end) for them on all the workers
+	// returns when every range is done, the calling thread helps with the work in the meantime
+	template <typename TFunction> void ParallelFor(int count, int grainSize, const TFunction& function);
+};
+
+template <typename TFunction>
+void JobSystem::ParallelFor(int count, int grainSize, const TFunction& function) {
+	// the function lives on the stack of the caller, which is fine because ParallelFor waits for all jobs
+	ParallelFor(count, grainSize, [](void* data, int begin, int end) {
+		(*static_cast<const TFunction*>(data))(begin, end);
+	}, const_cast<TFunction*>(&function));
+}
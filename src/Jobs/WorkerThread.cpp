@@ -0,0 +1,47 @@
+#include "WorkerThread.h"
+
+WorkerThread::WorkerThread() {
+	thread = std::thread(&WorkerThread::Loop, this);
+}
+
+WorkerThread::~WorkerThread() {
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isRunning = false;
+	}
+	wakeUp.notify_one();
+	thread.join();
+}
+
+void WorkerThread::Loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wakeUp.wait(lock, [this] { return hasTask || !isRunning; });
+		if (!hasTask) {
+			return;
+		}
+
+		lock.unlock();
+		task();
+		lock.lock();
+
+		hasTask = false;
+		finished.notify_all();
+	}
+}
+
+void WorkerThread::Run(std::function<void()> task) {
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = std::move(task);
+		hasTask = true;
+	}
+	wakeUp.notify_one();
+}
+
+void WorkerThread::Wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return !hasTask; });
+}
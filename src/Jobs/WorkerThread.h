@@ -0,0 +1,32 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// a thread of its own for one long task at a time, which should overlap with the work of the calling thread
+// (the simulation of the next frame while the current one gets drawn), short parallel work belongs to the JobSystem
+class WorkerThread {
+private:
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::condition_variable finished;
+	std::function<void()> task;
+	bool hasTask = false;
+	bool isRunning = true;
+
+	void Loop();
+
+public:
+	WorkerThread();
+	~WorkerThread();
+	WorkerThread(const WorkerThread&) = delete;
+	WorkerThread& operator =(const WorkerThread&) = delete;
+
+	// starts the task on the thread and returns right away, waits for the task before if there still is one
+	void Run(std::function<void()> task);
+	// returns when the task is done
+	void Wait();
+};
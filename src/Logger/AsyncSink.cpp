@@ -0,0 +1,204 @@
+#include "AsyncSink.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+AsyncSink::AsyncSink(std::vector<spdlog::sink_ptr> targets) : targets(std::move(targets)) {
+	messages = std::make_unique<Message[]>(CAPACITY);
+	for (size_t i = 0; i < CAPACITY; i++) {
+		messages[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	writePosition = 0;
+	readPosition = 0;
+	droppedMessages = 0;
+	isClosed = false;
+	activeWriters = 0;
+	writer = std::thread(&AsyncSink::WriterLoop, this);
+}
+
+AsyncSink::~AsyncSink() {
+	Stop();
+}
+
+void AsyncSink::log(const spdlog::details::log_msg& message) {
+	if (!BeginWrite()) {
+		std::lock_guard<std::mutex> lock(targetsMutex);
+		WriteToTargets(message);
+		return;
+	}
+
+	size_t position;
+	Message* slot = Reserve(position);
+	if (slot) {
+		SetHeader(slot, message.time, message.thread_id, message.logger_name, message.source, message.level);
+		slot->textLength = std::min(message.payload.size(), MAX_MESSAGE_LENGTH);
+		std::memcpy(slot->text, message.payload.data(), slot->textLength);
+		Publish(slot, position);
+	}
+	EndWrite();
+}
+
+bool AsyncSink::BeginWrite() {
+	// announced before looking at isClosed, so Stop() either sees the writer or the writer sees isClosed
+	activeWriters.fetch_add(1, std::memory_order_seq_cst);
+	if (isClosed.load(std::memory_order_seq_cst)) {
+		activeWriters.fetch_sub(1, std::memory_order_release);
+		return false;
+	}
+	return true;
+}
+
+void AsyncSink::EndWrite() {
+	activeWriters.fetch_sub(1, std::memory_order_release);
+}
+
+AsyncSink::Message* AsyncSink::Reserve(size_t& position) {
+	position = writePosition.load(std::memory_order_relaxed);
+	while (true) {
+		Message* slot = &messages[position & (CAPACITY - 1)];
+		const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+		if (difference == 0) {
+			if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				return slot;
+			}
+		}
+		else if (difference < 0) {
+			// full, waiting for the writer thread would block the frame
+			droppedMessages.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else {
+			position = writePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void AsyncSink::Publish(Message* slot, size_t position) {
+	slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void AsyncSink::SetHeader(Message* slot, spdlog::log_clock::time_point time, size_t threadId, spdlog::string_view_t loggerName, spdlog::source_loc source, spdlog::level::level_enum level) {
+	slot->time = time;
+	slot->level = level;
+	slot->threadId = threadId;
+	slot->source = source;
+	slot->loggerNameLength = std::min(loggerName.size(), MAX_NAME_LENGTH);
+	std::memcpy(slot->loggerName, loggerName.data(), slot->loggerNameLength);
+}
+
+bool AsyncSink::WriteNext() {
+	const size_t position = readPosition.load(std::memory_order_relaxed);
+	Message& slot = messages[position & (CAPACITY - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+		return false;
+	}
+
+	spdlog::details::log_msg message(
+		slot.time,
+		slot.source,
+		spdlog::string_view_t(slot.loggerName, slot.loggerNameLength),
+		slot.level,
+		spdlog::string_view_t(slot.text, slot.textLength)
+	);
+	message.thread_id = slot.threadId;
+	WriteToTargets(message);
+
+	slot.sequence.store(position + CAPACITY, std::memory_order_release);
+	readPosition.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+void AsyncSink::WriteToTargets(const spdlog::details::log_msg& message) {
+	for (auto& target : targets) {
+		if (target->should_log(message.level)) {
+			target->log(message);
+		}
+	}
+}
+
+void AsyncSink::WriterLoop() {
+	while (true) {
+		// checked before the messages get written: once it is closed and nobody is in the middle of a message,
+		// every claimed slot is published and this pass empties the ring buffer
+		const bool isLastPass = isClosed.load(std::memory_order_seq_cst) && activeWriters.load(std::memory_order_seq_cst) == 0;
+
+		bool wroteMessages = false;
+		{
+			std::lock_guard<std::mutex> lock(targetsMutex);
+			while (WriteNext()) {
+				wroteMessages = true;
+			}
+
+			const size_t dropped = droppedMessages.load(std::memory_order_relaxed);
+			if (dropped != reportedDroppedMessages) {
+				const std::string text = std::to_string(dropped - reportedDroppedMessages) + " log messages were dropped, the log buffer was full";
+				WriteToTargets(spdlog::details::log_msg("Logger", spdlog::level::warn, text));
+				reportedDroppedMessages = dropped;
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(waitMutex);
+		if (wroteMessages) {
+			written.notify_all();
+		}
+		if (isLastPass) {
+			break;
+		}
+		// the logging threads don't notify (that could block them), so the writer looks again after a while
+		// flush() and Stop() wake it up right away
+		if (!wroteMessages && !isClosed.load(std::memory_order_acquire)) {
+			wakeUp.wait_for(lock, std::chrono::milliseconds(1));
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(waitMutex);
+	written.notify_all();
+}
+
+void AsyncSink::flush() {
+	{
+		const size_t position = writePosition.load(std::memory_order_acquire);
+		std::unique_lock<std::mutex> lock(waitMutex);
+		wakeUp.notify_one();
+		// after Stop() the last pass of the writer thread emptied the ring buffer, so this doesn't wait
+		written.wait(lock, [this, position] { return readPosition.load(std::memory_order_acquire) >= position; });
+	}
+	std::lock_guard<std::mutex> lock(targetsMutex);
+	for (auto& target : targets) {
+		target->flush();
+	}
+}
+
+void AsyncSink::set_pattern(const std::string& pattern) {
+	std::lock_guard<std::mutex> lock(targetsMutex);
+	for (auto& target : targets) {
+		target->set_pattern(pattern);
+	}
+}
+
+void AsyncSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter) {
+	std::lock_guard<std::mutex> lock(targetsMutex);
+	for (auto& target : targets) {
+		target->set_formatter(formatter->clone());
+	}
+}
+
+void AsyncSink::Stop() {
+	if (!writer.joinable()) {
+		return;
+	}
+	// no new slots get claimed, the writer thread empties the ring buffer once the started messages are published
+	{
+		std::lock_guard<std::mutex> lock(waitMutex);
+		isClosed.store(true, std::memory_order_seq_cst);
+	}
+	wakeUp.notify_one();
+	writer.join();
+
+	std::lock_guard<std::mutex> lock(targetsMutex);
+	for (auto& target : targets) {
+		target->flush();
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+#include <spdlog/details/os.h>
+#include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+
+// spdlog sink which only copies the formatted message into a bounded lock-free ring buffer,
+// a background thread writes the messages to the real sinks (console, file, ...)
+// the logging thread never allocates, locks or waits: long messages get cut off
+// and when the ring buffer is full the message is dropped (and counted)
+// the LOG_* macros format straight into the ring buffer with Log(), log() gets messages spdlog formatted already
+// (spdlog formats into a buffer on the stack which allocates for messages over 250 characters)
+class AsyncSink : public spdlog::sinks::sink {
+private:
+	static constexpr size_t CAPACITY = 4096; // power of two
+	static constexpr size_t MAX_MESSAGE_LENGTH = 400;
+	static constexpr size_t MAX_NAME_LENGTH = 16;
+
+	struct Message {
+		// Vyukov's bounded queue: sequence == position + 1 once the message is written,
+		// sequence == position + CAPACITY once it was read and the slot is free again
+		std::atomic<size_t> sequence;
+		spdlog::log_clock::time_point time;
+		spdlog::level::level_enum level;
+		size_t threadId;
+		spdlog::source_loc source;
+		char loggerName[MAX_NAME_LENGTH];
+		size_t loggerNameLength;
+		char text[MAX_MESSAGE_LENGTH];
+		size_t textLength;
+	};
+
+	std::unique_ptr<Message[]> messages;
+	alignas(64) std::atomic<size_t> writePosition;
+	alignas(64) std::atomic<size_t> readPosition; // only changed by the writer thread
+	std::atomic<size_t> droppedMessages;
+	size_t reportedDroppedMessages = 0;
+
+	std::vector<spdlog::sink_ptr> targets;
+	std::mutex targetsMutex; // only the writer thread and the setters use the targets
+	std::thread writer;
+	std::atomic<bool> isClosed; // set by Stop(), no more slots get claimed after that
+	std::atomic<int> activeWriters; // threads between BeginWrite() and EndWrite(), Stop() lets them finish their message
+	std::mutex waitMutex;
+	std::condition_variable wakeUp; // the writer thread sleeps on it while the ring buffer is empty
+	std::condition_variable written; // flush() waits on it until the writer thread got to its message
+
+	// false once Stop() was called, then the message gets written directly
+	// otherwise EndWrite() has to follow after the message was published or dropped
+	bool BeginWrite();
+	void EndWrite();
+	// a free slot for the message at position, nullptr if the ring buffer is full (the message is dropped)
+	Message* Reserve(size_t& position);
+	// hands the written slot to the writer thread
+	void Publish(Message* slot, size_t position);
+	static void SetHeader(Message* slot, spdlog::log_clock::time_point time, size_t threadId, spdlog::string_view_t loggerName, spdlog::source_loc source, spdlog::level::level_enum level);
+
+	void WriterLoop();
+	// writes the next message to the targets, false if the ring buffer is empty
+	bool WriteNext();
+	void WriteToTargets(const spdlog::details::log_msg& message);
+
+public:
+	AsyncSink(std::vector<spdlog::sink_ptr> targets);
+	~AsyncSink();
+	AsyncSink(const AsyncSink&) = delete;
+	AsyncSink& operator =(const AsyncSink&) = delete;
+
+	void log(const spdlog::details::log_msg& message) override;
+	// formats the message into the ring buffer, cut off after MAX_MESSAGE_LENGTH characters
+	template <typename ...TArgs> void Log(spdlog::string_view_t loggerName, spdlog::source_loc source, spdlog::level::level_enum level, spdlog::format_string_t<TArgs...> format, TArgs&& ...args);
+	// blocks until the messages logged before are written
+	void flush() override;
+	void set_pattern(const std::string& pattern) override;
+	void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+	// writes the remaining messages and stops the writer thread, later messages are written directly
+	void Stop();
+};
+
+template <typename ...TArgs>
+void AsyncSink::Log(spdlog::string_view_t loggerName, spdlog::source_loc source, spdlog::level::level_enum level, spdlog::format_string_t<TArgs...> format, TArgs&& ...args) {
+	if (!BeginWrite()) {
+		// after Stop() the message gets written right away, allocating doesn't matter anymore
+		spdlog::memory_buf_t text;
+		fmt::format_to(std::back_inserter(text), format, std::forward<TArgs>(args)...);
+		log(spdlog::details::log_msg(source, loggerName, level, spdlog::string_view_t(text.data(), text.size())));
+		return;
+	}
+
+	size_t position;
+	Message* slot = Reserve(position);
+	if (slot) {
+		SetHeader(slot, spdlog::log_clock::now(), spdlog::details::os::thread_id(), loggerName, source, level);
+		const auto result = fmt::format_to_n(slot->text, MAX_MESSAGE_LENGTH, format, std::forward<TArgs>(args)...);
+		slot->textLength = std::min(result.size, MAX_MESSAGE_LENGTH);
+		Publish(slot, position);
+	}
+	EndWrite();
+}
@@ -0,0 +1,45 @@
+#include "Logger.h"
+#include "AsyncSink.h"
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+namespace {
+	struct Loggers {
+		std::shared_ptr<AsyncSink> sink;
+		std::shared_ptr<spdlog::logger> loggers[static_cast<int>(Logger::Subsystem::Count)];
+
+		Loggers() {
+			sink = std::make_shared<AsyncSink>(std::vector<spdlog::sink_ptr>{ std::make_shared<spdlog::sinks::stdout_color_sink_mt>() });
+
+			const char* names[] = { "Core", "ECS", "Assets", "Render", "Script" };
+			for (int i = 0; i < static_cast<int>(Logger::Subsystem::Count); i++) {
+				loggers[i] = std::make_shared<spdlog::logger>(names[i], sink);
+				// takes the global level and pattern, so Logger::set_level also changes these loggers
+				spdlog::initialize_logger(loggers[i]);
+			}
+
+			// the old Logger::info(...) calls go through the same sink
+			spdlog::set_default_logger(loggers[static_cast<int>(Logger::Subsystem::Core)]);
+		}
+
+		~Loggers() {
+			sink->Stop();
+		}
+	};
+
+	Loggers& GetLoggers() {
+		static Loggers loggers;
+		return loggers;
+	}
+}
+
+spdlog::logger* Logger::Get(Subsystem subsystem) {
+	return GetLoggers().loggers[static_cast<int>(subsystem)].get();
+}
+
+AsyncSink* Logger::GetSink() {
+	return GetLoggers().sink.get();
+}
+
+void Logger::Flush() {
+	GetLoggers().sink->flush();
+}
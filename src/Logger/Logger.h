@@ -1,6 +1,87 @@
 #pragma once
 
+// log calls below SPDLOG_ACTIVE_LEVEL get removed by the preprocessor, the arguments aren't even evaluated
+// (can be overwritten in the project settings, for example SPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_OFF)
+#ifndef SPDLOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#else
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+#endif
+
 #include <spdlog/spdlog.h>
+#include "AsyncSink.h"
+
+// abstract Logger namespace (Logger::set_level etc. still go to spdlog)
+namespace Logger {
+	using namespace spdlog;
+
+	// every subsystem has its own logger, so its level can be changed on its own
+	// Logger::Get(Logger::Subsystem::ECS)->set_level(Logger::level::warn);
+	enum class Subsystem {
+		Core,
+		ECS,
+		Assets,
+		Render,
+		Script,
+		Count
+	};
+
+	// all the loggers write into one asynchronous sink (see AsyncSink.h),
+	// they get created with the first call
+	spdlog::logger* Get(Subsystem subsystem);
+	AsyncSink* GetSink();
+
+	// blocks until all the queued messages are written
+	void Flush();
+
+	// what the LOG_* macros call: formats straight into the ring buffer of the sink, so logging never allocates
+	template <typename ...TArgs>
+	void Log(Subsystem subsystem, spdlog::source_loc source, spdlog::level::level_enum level, spdlog::format_string_t<TArgs...> format, TArgs&& ...args) {
+		spdlog::logger* logger = Get(subsystem);
+		if (logger->should_log(level)) {
+			GetSink()->Log(logger->name(), source, level, format, std::forward<TArgs>(args)...);
+		}
+	}
+}
+
+// the messages get formatted with fmt only if the level of the logger is enabled:
+// LOG_DEBUG(ECS, "Entity created with id = {}", entityId);
+#define LOGGER_CALL(subsystem, level, ...) Logger::Log(Logger::Subsystem::subsystem, spdlog::source_loc{ __FILE__, __LINE__, SPDLOG_FUNCTION }, level, __VA_ARGS__)
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(subsystem, ...) LOGGER_CALL(subsystem, spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(subsystem, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(subsystem, ...) LOGGER_CALL(subsystem, spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(subsystem, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(subsystem, ...) LOGGER_CALL(subsystem, spdlog::level::info, __VA_ARGS__)
+#else
+#define LOG_INFO(subsystem, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define LOG_WARN(subsystem, ...) LOGGER_CALL(subsystem, spdlog::level::warn, __VA_ARGS__)
+#else
+#define LOG_WARN(subsystem, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define LOG_ERROR(subsystem, ...) LOGGER_CALL(subsystem, spdlog::level::err, __VA_ARGS__)
+#else
+#define LOG_ERROR(subsystem, ...) (void)0
+#endif
 
-// abstract Logger namespace
-namespace Logger = spdlog;
\ No newline at end of file
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
+#define LOG_CRITICAL(subsystem, ...) LOGGER_CALL(subsystem, spdlog::level::critical, __VA_ARGS__)
+#else
+#define LOG_CRITICAL(subsystem, ...) (void)0
+#endif
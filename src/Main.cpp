@@ -1,13 +1,60 @@
 #include "Game/Game.h"
+#include "Benchmark/ECSBenchmark.h"
+#include "Benchmark/EventBenchmark.h"
+#include "Tilemap/TilemapFile.h"
+#include "AssetManager/TextureAtlas.h"
+#include <string>
+#include <cstdlib>
+#include <algorithm>
 
 ////////////////////////////////////////////////////////////////////
 //   BIGTODO: Make this standalone application and not Librarie   //
 ////////////////////////////////////////////////////////////////////
 
 int main(int argc, char* argv[]) {
+    GameOptions options;
+    // "--benchmark" runs the ECS and event benchmarks instead of the game
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--benchmark") {
+            Benchmark::RunECSBenchmark();
+            Benchmark::RunEventBenchmark();
+            return 0;
+        }
+        // "--compile-tilemap <source.map> <target.jmap>" compiles a tilemap for shipping
+        if (std::string(argv[i]) == "--compile-tilemap" && i + 2 < argc) {
+            return TilemapFile::Compile(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        }
+        // "--build-atlas <image directory> <atlas path>" packs the sprite images for shipping, the game loads them without packing
+        if (std::string(argv[i]) == "--build-atlas" && i + 2 < argc) {
+            TextureAtlas atlas;
+            atlas.AddImages(argv[i + 1]);
+            return atlas.Pack() && atlas.Save(argv[i + 2]) ? 0 : 1;
+        }
+        // "--headless" runs without a window and without drawing, "--software-renderer" draws into memory instead
+        if (std::string(argv[i]) == "--headless") {
+            options.isHeadless = true;
+        }
+        if (std::string(argv[i]) == "--software-renderer") {
+            options.isHeadless = true;
+            options.useSoftwareRenderer = true;
+        }
+        // "--frames <count>" quits after so many frames and logs the frame times
+        if (std::string(argv[i]) == "--frames" && i + 1 < argc) {
+            options.numFrames = std::max(std::atoi(argv[++i]), 0);
+        }
+        // "--simulation-rate <steps per second>"
+        if (std::string(argv[i]) == "--simulation-rate" && i + 1 < argc) {
+            options.simulationRate = std::max(std::atoi(argv[++i]), 1);
+        }
+    }
+    // nobody closes the window of a headless run, so it stops by itself
+    if (options.isHeadless && options.numFrames == 0) {
+        options.numFrames = 1000;
+    }
+
     Game game;
 
-    game.Initialize();
+    game.Initialize(options);
     game.Run();
     game.Destroy();
 
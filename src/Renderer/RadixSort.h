@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// sorts items by their uint64_t member "key" with a least significant digit radix sort:
+// stable and linear in the number of items, 8 passes of one byte each
+// a pass is skipped if all the keys have the same byte there (unused bits of the key cost nothing)
+// buffer is scratch memory kept by the caller, so sorting every frame doesn't allocate
+template <typename TItem>
+void RadixSort(std::vector<TItem>& items, std::vector<TItem>& buffer) {
+	const size_t count = items.size();
+	if (count < 2) {
+		return;
+	}
+	buffer.resize(count);
+
+	// the histograms of all the passes in one go over the keys
+	size_t offsets[8][256] = {};
+	for (const TItem& item : items) {
+		uint64_t key = item.key;
+		for (int pass = 0; pass < 8; pass++) {
+			offsets[pass][key & 0xFF]++;
+			key >>= 8;
+		}
+	}
+
+	TItem* source = items.data();
+	TItem* target = buffer.data();
+	bool isSortedInBuffer = false;
+	for (int pass = 0; pass < 8; pass++) {
+		const int shift = pass * 8;
+		size_t* offset = offsets[pass];
+		if (offset[(source[0].key >> shift) & 0xFF] == count) {
+			continue;
+		}
+		size_t start = 0;
+		for (int digit = 0; digit < 256; digit++) {
+			const size_t digitCount = offset[digit];
+			offset[digit] = start;
+			start += digitCount;
+		}
+		for (size_t i = 0; i < count; i++) {
+			target[offset[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+		std::swap(source, target);
+		isSortedInBuffer = !isSortedInBuffer;
+	}
+	if (isSortedInBuffer) {
+		items.swap(buffer);
+	}
+}
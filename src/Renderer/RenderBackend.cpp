@@ -0,0 +1,61 @@
+#include "RenderBackend.h"
+
+void RenderBackend::Submit(SDL_Renderer* renderer, const RenderCommandList& commands) {
+	numDrawCalls = 0;
+	numSprites = 0;
+	SDL_RenderSetClipRect(renderer, nullptr);
+
+	const std::vector<SpriteQuad>& sprites = commands.GetSprites();
+	for (const RenderCommand& command : commands.GetCommands()) {
+		switch (command.type) {
+			case RenderCommandType::Clear:
+				SDL_SetRenderDrawColor(renderer, command.clearColor.r, command.clearColor.g, command.clearColor.b, command.clearColor.a);
+				SDL_RenderClear(renderer);
+				break;
+			case RenderCommandType::ClipRect:
+				SDL_RenderSetClipRect(renderer, command.clipRect.w > 0 ? &command.clipRect : nullptr);
+				break;
+			case RenderCommandType::Tilemap: {
+				const RenderView& view = command.tilemap.view;
+				CameraComponent camera(view.viewportWidth, view.viewportHeight, view.zoom);
+				camera.position = glm::vec2(view.x, view.y);
+				tilemapRenderer.Render(renderer, *command.tilemap.tilemap, command.tilemap.tileset, camera);
+				numDrawCalls += tilemapRenderer.GetNumDrawnChunks();
+				break;
+			}
+			case RenderCommandType::Sprites: {
+				spriteBatch.Begin();
+				const SpriteQuad* sprite = sprites.data() + command.sprites.first;
+				for (uint32_t i = 0; i < command.sprites.count; i++, sprite++) {
+					spriteBatch.Draw(sprite->texture, sprite->srcRect, sprite->dstRect, sprite->angle);
+				}
+				spriteBatch.End(renderer);
+				numDrawCalls += spriteBatch.GetNumDrawCalls();
+				numSprites += spriteBatch.GetNumSprites();
+				break;
+			}
+		}
+	}
+
+	SDL_RenderPresent(renderer);
+}
+
+void RenderBackend::Invalidate() {
+	tilemapRenderer.Invalidate();
+}
+
+void RenderBackend::Clear() {
+	tilemapRenderer.Clear();
+}
+
+int RenderBackend::GetNumDrawCalls() const {
+	return numDrawCalls;
+}
+
+int RenderBackend::GetNumSprites() const {
+	return numSprites;
+}
+
+const TilemapRenderer& RenderBackend::GetTilemapRenderer() const {
+	return tilemapRenderer;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SDL.h>
+#include "RenderCommandList.h"
+#include "SpriteBatch.h"
+#include "../Tilemap/TilemapRenderer.h"
+
+// draws the command lists recorded by the simulation, the only code which uses the SDL_Renderer while the game runs
+// it runs on the thread which created the renderer, while the simulation records the next frame on another one
+class RenderBackend {
+private:
+	SpriteBatch spriteBatch;
+	TilemapRenderer tilemapRenderer;
+	int numDrawCalls = 0;
+	int numSprites = 0;
+
+public:
+	RenderBackend() = default;
+	RenderBackend(const RenderBackend&) = delete;
+	RenderBackend& operator =(const RenderBackend&) = delete;
+
+	// draws the frame and presents it
+	void Submit(SDL_Renderer* renderer, const RenderCommandList& commands);
+	// the content of the render targets got lost (SDL_RENDER_TARGETS_RESET), the textures are still there
+	void Invalidate();
+	// frees the textures of the backend, has to happen before the renderer gets destroyed
+	// and after SDL_RENDER_DEVICE_RESET (the textures are dead), new ones get created when they are needed
+	void Clear();
+
+	// statistics of the last Submit()
+	int GetNumDrawCalls() const;
+	int GetNumSprites() const;
+	const TilemapRenderer& GetTilemapRenderer() const;
+};
@@ -0,0 +1,46 @@
+#include "RenderCommandList.h"
+
+void RenderCommandList::Reset() {
+	commands.clear();
+	sprites.clear();
+}
+
+void RenderCommandList::AddClear(SDL_Color color) {
+	RenderCommand command;
+	command.type = RenderCommandType::Clear;
+	command.clearColor = color;
+	commands.push_back(command);
+}
+
+void RenderCommandList::AddClipRect(const SDL_Rect* rect) {
+	RenderCommand command;
+	command.type = RenderCommandType::ClipRect;
+	command.clipRect = rect ? *rect : SDL_Rect{ 0, 0, 0, 0 };
+	commands.push_back(command);
+}
+
+void RenderCommandList::AddTilemap(const Tilemap& tilemap, SDL_Texture* tileset, const RenderView& view) {
+	RenderCommand command;
+	command.type = RenderCommandType::Tilemap;
+	command.tilemap = { &tilemap, tileset, view };
+	commands.push_back(command);
+}
+
+void RenderCommandList::AddSprite(const SpriteQuad& sprite) {
+	if (commands.empty() || commands.back().type != RenderCommandType::Sprites) {
+		RenderCommand command;
+		command.type = RenderCommandType::Sprites;
+		command.sprites = { static_cast<uint32_t>(sprites.size()), 0 };
+		commands.push_back(command);
+	}
+	sprites.push_back(sprite);
+	commands.back().sprites.count++;
+}
+
+const std::vector<RenderCommand>& RenderCommandList::GetCommands() const {
+	return commands;
+}
+
+const std::vector<SpriteQuad>& RenderCommandList::GetSprites() const {
+	return sprites;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <SDL.h>
+
+class Tilemap;
+
+// what the camera of a frame sees, see CameraComponent
+struct RenderView {
+	float x;
+	float y;
+	float zoom;
+	int viewportWidth;
+	int viewportHeight;
+};
+
+// a sprite on the screen, ready for the SpriteBatch
+struct SpriteQuad {
+	SDL_Texture* texture;
+	SDL_Rect srcRect;
+	SDL_FRect dstRect;
+	double angle; // degrees clockwise
+};
+
+enum class RenderCommandType : uint8_t {
+	Clear,
+	ClipRect,
+	Tilemap,
+	Sprites
+};
+
+struct RenderCommand {
+	struct TilemapDraw {
+		const Tilemap* tilemap;
+		SDL_Texture* tileset;
+		RenderView view;
+	};
+	struct SpriteRange {
+		uint32_t first; // in the sprites of the list
+		uint32_t count;
+	};
+
+	RenderCommandType type;
+	union {
+		SDL_Color clearColor;
+		SDL_Rect clipRect; // 0 width = no clipping
+		TilemapDraw tilemap;
+		SpriteRange sprites;
+	};
+};
+
+static_assert(std::is_trivially_copyable<RenderCommand>::value && std::is_trivially_copyable<SpriteQuad>::value, "render commands are plain data");
+
+// a frame for the RenderBackend, recorded by the simulation without touching the SDL_Renderer
+// only plain data: the textures are handles, the backend does all the SDL calls
+// the vectors keep their memory over the frames, so recording doesn't allocate once they are big enough
+class RenderCommandList {
+private:
+	std::vector<RenderCommand> commands;
+	std::vector<SpriteQuad> sprites;
+
+public:
+	// empties the list for the next frame
+	void Reset();
+
+	void AddClear(SDL_Color color);
+	// nullptr turns clipping off
+	void AddClipRect(const SDL_Rect* rect);
+	// the tilemap has to stay unchanged until the frame is drawn
+	void AddTilemap(const Tilemap& tilemap, SDL_Texture* tileset, const RenderView& view);
+	// sprites added one after the other end up in the same command
+	void AddSprite(const SpriteQuad& sprite);
+
+	const std::vector<RenderCommand>& GetCommands() const;
+	const std::vector<SpriteQuad>& GetSprites() const;
+};
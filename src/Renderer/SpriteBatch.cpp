@@ -0,0 +1,102 @@
+#include "SpriteBatch.h"
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+SpriteBatch::Batch& SpriteBatch::GetBatch(SDL_Texture* texture) {
+	if (numBatches > 0 && batches[numBatches - 1].texture == texture) {
+		return batches[numBatches - 1];
+	}
+
+	// a new texture starts a new batch, so the quads get drawn in the order they were added
+	if (numBatches == batches.size()) {
+		batches.emplace_back();
+	}
+	Batch& batch = batches[numBatches++];
+	batch.texture = texture;
+	batch.vertices.clear();
+
+	int width = 1;
+	int height = 1;
+	SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+	batch.inverseWidth = 1.0f / width;
+	batch.inverseHeight = 1.0f / height;
+	return batch;
+}
+
+void SpriteBatch::Begin() {
+	for (size_t i = 0; i < numBatches; i++) {
+		batches[i].vertices.clear();
+	}
+	numBatches = 0;
+	numSprites = 0;
+}
+
+void SpriteBatch::Draw(SDL_Texture* texture, const SDL_Rect& srcRect, const SDL_FRect& dstRect, double angle) {
+	if (!texture) {
+		return;
+	}
+	Batch& batch = GetBatch(texture);
+
+	const float u0 = srcRect.x * batch.inverseWidth;
+	const float v0 = srcRect.y * batch.inverseHeight;
+	const float u1 = (srcRect.x + srcRect.w) * batch.inverseWidth;
+	const float v1 = (srcRect.y + srcRect.h) * batch.inverseHeight;
+	const SDL_Color white = { 255, 255, 255, 255 };
+
+	// corners relative to the center: top left, top right, bottom right, bottom left
+	const float halfWidth = dstRect.w * 0.5f;
+	const float halfHeight = dstRect.h * 0.5f;
+	const float centerX = dstRect.x + halfWidth;
+	const float centerY = dstRect.y + halfHeight;
+	float cornersX[4] = { -halfWidth, halfWidth, halfWidth, -halfWidth };
+	float cornersY[4] = { -halfHeight, -halfHeight, halfHeight, halfHeight };
+	if (angle != 0.0) {
+		// y points down, so a positive angle turns clockwise on the screen
+		const double radians = glm::radians(angle);
+		const float cosAngle = static_cast<float>(std::cos(radians));
+		const float sinAngle = static_cast<float>(std::sin(radians));
+		for (int i = 0; i < 4; i++) {
+			const float x = cornersX[i];
+			cornersX[i] = x * cosAngle - cornersY[i] * sinAngle;
+			cornersY[i] = x * sinAngle + cornersY[i] * cosAngle;
+		}
+	}
+
+	batch.vertices.push_back({ { centerX + cornersX[0], centerY + cornersY[0] }, white, { u0, v0 } });
+	batch.vertices.push_back({ { centerX + cornersX[1], centerY + cornersY[1] }, white, { u1, v0 } });
+	batch.vertices.push_back({ { centerX + cornersX[2], centerY + cornersY[2] }, white, { u1, v1 } });
+	batch.vertices.push_back({ { centerX + cornersX[3], centerY + cornersY[3] }, white, { u0, v1 } });
+	numSprites++;
+}
+
+void SpriteBatch::End(SDL_Renderer* renderer) {
+	numDrawCalls = 0;
+
+	size_t maxQuads = 0;
+	for (size_t i = 0; i < numBatches; i++) {
+		maxQuads = std::max(maxQuads, batches[i].vertices.size() / 4);
+	}
+	for (size_t quad = indices.size() / 6; quad < maxQuads; quad++) {
+		const int vertex = static_cast<int>(quad * 4);
+		indices.insert(indices.end(), { vertex, vertex + 1, vertex + 2, vertex, vertex + 2, vertex + 3 });
+	}
+
+	for (size_t i = 0; i < numBatches; i++) {
+		const Batch& batch = batches[i];
+		if (batch.vertices.empty()) {
+			continue;
+		}
+		const int numVertices = static_cast<int>(batch.vertices.size());
+		SDL_RenderGeometry(renderer, batch.texture, batch.vertices.data(), numVertices, indices.data(), numVertices / 4 * 6);
+		numDrawCalls++;
+	}
+}
+
+int SpriteBatch::GetNumDrawCalls() const {
+	return numDrawCalls;
+}
+
+int SpriteBatch::GetNumSprites() const {
+	return numSprites;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <SDL.h>
+
+// collects textured quads and draws each run of quads with the same texture with a single SDL_RenderGeometry call
+// (needs SDL 2.0.18 or newer) instead of one SDL_RenderCopyEx per sprite
+// the quads get drawn in the order they were added, sorting them by texture where the order doesn't matter
+// (see RenderingSystem) keeps the number of draw calls down
+class SpriteBatch {
+private:
+	struct Batch {
+		SDL_Texture* texture = nullptr;
+		float inverseWidth = 1.0f; // texture size for the texture coordinates
+		float inverseHeight = 1.0f;
+		std::vector<SDL_Vertex> vertices; // 4 per quad
+	};
+
+	// kept over the frames so the vertex buffers don't get allocated again
+	std::vector<Batch> batches;
+	size_t numBatches = 0; // batches in use this frame
+	std::vector<int> indices; // 0 1 2 0 2 3 for every quad, the same for every batch
+	int numDrawCalls = 0;
+	int numSprites = 0;
+
+	Batch& GetBatch(SDL_Texture* texture);
+
+public:
+	SpriteBatch() = default;
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator =(const SpriteBatch&) = delete;
+
+	void Begin();
+	// like SDL_RenderCopyEx: angle in degrees clockwise around the center of dstRect
+	void Draw(SDL_Texture* texture, const SDL_Rect& srcRect, const SDL_FRect& dstRect, double angle = 0.0);
+	// submits the quads to the renderer, one call per texture
+	void End(SDL_Renderer* renderer);
+
+	// statistics of the last End()
+	int GetNumDrawCalls() const;
+	int GetNumSprites() const;
+};
@@ -0,0 +1,137 @@
+#include "SpatialGrid.h"
+#include <cmath>
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float cellSize) : cellSize(cellSize), inverseCellSize(1.0f / cellSize) {
+}
+
+uint64_t SpatialGrid::GetKey(int cellX, int cellY) {
+	return (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32) | static_cast<uint32_t>(cellY);
+}
+
+SpatialGrid::CellRange SpatialGrid::GetCellRange(const SDL_FRect& bounds) const {
+	CellRange range;
+	range.minX = static_cast<int>(std::floor(bounds.x * inverseCellSize));
+	range.minY = static_cast<int>(std::floor(bounds.y * inverseCellSize));
+	range.maxX = static_cast<int>(std::floor((bounds.x + std::max(bounds.w, 0.0f)) * inverseCellSize));
+	range.maxY = static_cast<int>(std::floor((bounds.y + std::max(bounds.h, 0.0f)) * inverseCellSize));
+	return range;
+}
+
+void SpatialGrid::AddToCells(int id, const CellRange& range) {
+	for (int y = range.minY; y <= range.maxY; y++) {
+		for (int x = range.minX; x <= range.maxX; x++) {
+			cells[GetKey(x, y)].push_back(id);
+		}
+	}
+}
+
+void SpatialGrid::RemoveFromCells(int id, const CellRange& range) {
+	for (int y = range.minY; y <= range.maxY; y++) {
+		for (int x = range.minX; x <= range.maxX; x++) {
+			auto cell = cells.find(GetKey(x, y));
+			if (cell == cells.end()) {
+				continue;
+			}
+			std::vector<int>& ids = cell->second;
+			auto position = std::find(ids.begin(), ids.end(), id);
+			if (position != ids.end()) {
+				// the order inside a cell doesn't matter
+				*position = ids.back();
+				ids.pop_back();
+			}
+		}
+	}
+}
+
+void SpatialGrid::Insert(int id, const SDL_FRect& bounds) {
+	if (id >= items.size()) {
+		items.resize(id + 1);
+		queryMarks.resize(id + 1, 0);
+	}
+
+	Item& item = items[id];
+	const CellRange range = GetCellRange(bounds);
+	if (item.isInserted) {
+		if (item.cells == range) {
+			return;
+		}
+		RemoveFromCells(id, item.cells);
+	}
+	else {
+		item.isInserted = true;
+		numItems++;
+	}
+	AddToCells(id, range);
+	item.cells = range;
+}
+
+void SpatialGrid::Remove(int id) {
+	if (!Contains(id)) {
+		return;
+	}
+	RemoveFromCells(id, items[id].cells);
+	items[id].isInserted = false;
+	numItems--;
+}
+
+bool SpatialGrid::Contains(int id) const {
+	return id >= 0 && id < items.size() && items[id].isInserted;
+}
+
+void SpatialGrid::Query(const SDL_FRect& area, std::vector<int>& result) {
+	if (++queryMark == 0) {
+		// wrapped around, old marks could look like the current one
+		std::fill(queryMarks.begin(), queryMarks.end(), 0);
+		queryMark = 1;
+	}
+
+	auto collect = [this, &result](const std::vector<int>& ids) {
+		for (int id : ids) {
+			if (queryMarks[id] != queryMark) {
+				queryMarks[id] = queryMark;
+				result.push_back(id);
+			}
+		}
+	};
+
+	const CellRange range = GetCellRange(area);
+	const int64_t numAreaCells = (static_cast<int64_t>(range.maxX) - range.minX + 1) * (static_cast<int64_t>(range.maxY) - range.minY + 1);
+	if (numAreaCells > static_cast<int64_t>(cells.size())) {
+		// zoomed far out: fewer existing cells than cells in the area
+		for (const auto& [key, ids] : cells) {
+			const int x = static_cast<int>(static_cast<uint32_t>(key >> 32));
+			const int y = static_cast<int>(static_cast<uint32_t>(key));
+			if (x < range.minX || x > range.maxX || y < range.minY || y > range.maxY) {
+				continue;
+			}
+			collect(ids);
+		}
+		return;
+	}
+
+	for (int y = range.minY; y <= range.maxY; y++) {
+		for (int x = range.minX; x <= range.maxX; x++) {
+			auto cell = cells.find(GetKey(x, y));
+			if (cell == cells.end()) {
+				continue;
+			}
+			collect(cell->second);
+		}
+	}
+}
+
+void SpatialGrid::Clear() {
+	cells.clear();
+	items.clear();
+	queryMarks.clear();
+	numItems = 0;
+}
+
+size_t SpatialGrid::GetNumItems() const {
+	return numItems;
+}
+
+float SpatialGrid::GetCellSize() const {
+	return cellSize;
+}
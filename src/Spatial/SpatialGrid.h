@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <SDL.h>
+
+// uniform grid over the world for area queries (culling, later collisions)
+// an item (entity id) is stored in every cell its bounding box overlaps and only cells with items exist,
+// so empty parts of a huge map cost no memory and a query only visits the cells of its area
+// moving an item inside the same cells doesn't touch the cells at all
+class SpatialGrid {
+private:
+	struct CellRange {
+		int minX = 0;
+		int minY = 0;
+		int maxX = -1;
+		int maxY = -1;
+
+		bool operator ==(const CellRange& other) const {
+			return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+		}
+	};
+
+	struct Item {
+		CellRange cells;
+		bool isInserted = false;
+	};
+
+	float cellSize;
+	float inverseCellSize;
+	// [cell x in the high, cell y in the low 32 bits] = ids of the items overlapping the cell
+	// emptied cells are kept, moving items come back to them
+	std::unordered_map<uint64_t, std::vector<int>> cells;
+	std::vector<Item> items; // [item id]
+	size_t numItems = 0;
+
+	// [item id] = last query which returned the item, so an item overlapping several cells comes once
+	std::vector<uint32_t> queryMarks;
+	uint32_t queryMark = 0;
+
+	static uint64_t GetKey(int cellX, int cellY);
+	CellRange GetCellRange(const SDL_FRect& bounds) const;
+	void AddToCells(int id, const CellRange& range);
+	void RemoveFromCells(int id, const CellRange& range);
+
+public:
+	explicit SpatialGrid(float cellSize = 256.0f);
+
+	// inserts the item or moves it to its new bounds
+	void Insert(int id, const SDL_FRect& bounds);
+	void Remove(int id);
+	bool Contains(int id) const;
+	// appends the ids of the items in the cells overlapping the area, every id once
+	// (items near the area can be returned too, the caller tests the exact bounds)
+	void Query(const SDL_FRect& area, std::vector<int>& result);
+	void Clear();
+
+	size_t GetNumItems() const;
+	float GetCellSize() const;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include "../ECS/ECS.h"
+#include "../Components/AnimationComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Animation/AnimationLibrary.h"
+
+// moves the animations forward and shows their current frame in the sprites
+// the clips are shared and read only, an entity only has a clip id, its time and frame,
+// and the frame is one lookup in the tick table of the clip, so the loop over the packed components hardly branches
+// a new frame only changes the srcRect, which doesn't count as a change of the sprite (ViewChanged), its bounds stay the same
+class AnimationSystem : public System {
+private:
+	const AnimationLibrary& library;
+
+	static void Animate(const AnimationLibrary& library, float deltaTime, AnimationComponent& animation, SpriteComponent& sprite) {
+		const AnimationClip& clip = library.GetClip(animation.clipId);
+		const float time = animation.time + deltaTime;
+		// looping clips wrap around, the others stay at their end
+		const float wrappedTime = time - clip.duration * std::floor(time * clip.inverseDuration);
+		animation.time = clip.isLooping ? wrappedTime : std::min(time, clip.duration);
+		animation.frame = library.GetFrame(clip, animation.time);
+		sprite.srcRect = library.GetFrameRect(clip, animation.frame);
+	}
+
+public:
+	AnimationSystem(const AnimationLibrary& library) : library(library) {
+		RequireComponent<AnimationComponent>();
+		RequireComponent<SpriteComponent>();
+	}
+
+	void Update(double deltaTime) {
+		if (GetSystemEnties().IsEmpty()) {
+			return;
+		}
+
+		const AnimationLibrary& library = this->library;
+		const float delta = static_cast<float>(deltaTime);
+		const unsigned int numClips = static_cast<unsigned int>(library.GetNumClips());
+
+		if (IsParallel() && registry->GetJobSystem()) {
+			registry->View<AnimationComponent, SpriteComponent>().ParallelEach(*registry->GetJobSystem(), [&library, delta, numClips](Entity entity, AnimationComponent& animation, SpriteComponent& sprite) {
+				if (static_cast<unsigned int>(animation.clipId) < numClips) {
+					Animate(library, delta, animation, sprite);
+				}
+			});
+			return;
+		}
+
+		// with archetypes the animations and sprites lie next to each other in the chunks
+		registry->ForEachChunk<AnimationComponent, SpriteComponent>([&library, delta, numClips](int count, const int* entityIds, AnimationComponent* animations, SpriteComponent* sprites) {
+			for (int i = 0; i < count; i++) {
+				// a clip id of -1 is no animation
+				if (static_cast<unsigned int>(animations[i].clipId) < numClips) {
+					Animate(library, delta, animations[i], sprites[i]);
+				}
+			}
+		});
+	}
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cmath>
+#include <glm/glm.hpp>
+#include <SDL.h>
+#include "../ECS/ECS.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/KeyPressedEvent.h"
+#include "../Components/CameraComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/SpriteComponent.h"
+
+// moves every camera to the center of its target and keeps it inside its bounds
+// runs after the systems which move the targets, so the camera shows where they are this frame
+class CameraSystem : public System {
+private:
+	static constexpr float ZOOM_STEP = 1.25f;
+	static constexpr float MIN_ZOOM = 0.125f;
+	static constexpr float MAX_ZOOM = 8.0f;
+
+	// a view bigger than the bounds gets centered on them
+	static float Clamp(float position, float viewSize, int boundsPosition, int boundsSize) {
+		if (boundsSize <= 0) {
+			return position;
+		}
+		if (viewSize >= boundsSize) {
+			return boundsPosition + (boundsSize - viewSize) * 0.5f;
+		}
+		return glm::clamp(position, static_cast<float>(boundsPosition), boundsPosition + boundsSize - viewSize);
+	}
+
+	bool GetTargetCenter(const CameraComponent& camera, glm::vec2& center) const {
+		if (!camera.hasTarget || !registry->IsAlive(camera.target) || !registry->HasComponent<TransformComponent>(camera.target)) {
+			return false;
+		}
+		const Registry& constRegistry = *registry;
+		const TransformComponent& transform = constRegistry.GetComponent<TransformComponent>(camera.target);
+		center = transform.position;
+		// the position of a sprite is its top left corner
+		if (registry->HasComponent<SpriteComponent>(camera.target)) {
+			const SpriteComponent& sprite = constRegistry.GetComponent<SpriteComponent>(camera.target);
+			center += glm::vec2(sprite.width * transform.scale.x, sprite.height * transform.scale.y) * 0.5f;
+		}
+		return true;
+	}
+
+	void OnKeyPressed(const KeyPressedEvent& event) {
+		float factor = 1.0f;
+		if (event.key == SDLK_PLUS || event.key == SDLK_EQUALS || event.key == SDLK_KP_PLUS) {
+			factor = ZOOM_STEP;
+		}
+		else if (event.key == SDLK_MINUS || event.key == SDLK_KP_MINUS) {
+			factor = 1.0f / ZOOM_STEP;
+		}
+		else {
+			return;
+		}
+		for (Entity entity : GetSystemEnties()) {
+			registry->Patch<CameraComponent>(entity, [factor](CameraComponent& camera) {
+				camera.zoom = glm::clamp(camera.zoom * factor, MIN_ZOOM, MAX_ZOOM);
+			});
+		}
+	}
+
+public:
+	CameraSystem() {
+		RequireComponent<CameraComponent>();
+		UseComponent<TransformComponent>(ComponentAccess::Read);
+		UseComponent<SpriteComponent>(ComponentAccess::Read);
+	}
+
+	// +/- zoom in and out
+	void SubscribeToEvents(EventBus& eventBus) {
+		eventBus.Subscribe<KeyPressedEvent, CameraSystem, &CameraSystem::OnKeyPressed>(this);
+	}
+
+	void Update(double deltaTime) {
+		for (Entity entity : GetSystemEnties()) {
+			CameraComponent& camera = registry->GetComponent<CameraComponent>(entity);
+			camera.previousPosition = camera.position;
+			const glm::vec2 viewSize = camera.GetViewSize();
+
+			glm::vec2 center;
+			if (GetTargetCenter(camera, center)) {
+				const glm::vec2 wanted = center - viewSize * 0.5f;
+				if (camera.followSpeed > 0.0f) {
+					// framerate independent smoothing
+					const float t = 1.0f - static_cast<float>(std::exp(-camera.followSpeed * deltaTime));
+					camera.position += (wanted - camera.position) * t;
+				}
+				else {
+					camera.position = wanted;
+				}
+			}
+
+			camera.position.x = Clamp(camera.position.x, viewSize.x, camera.bounds.x, camera.bounds.w);
+			camera.position.y = Clamp(camera.position.y, viewSize.y, camera.bounds.y, camera.bounds.h);
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/LocalTransformComponent.h"
+#include "../Components/ParentComponent.h"
+
+// computes the TransformComponent (world transform) of every entity with a ParentComponent
+// from the transform of its parent and its LocalTransformComponent
+// the hierarchy is kept as a flat list sorted by depth with the transforms cached inside,
+// so parents always come before their children and one linear pass propagates everything
+// without looking up components, only the subtrees below a moved root or a changed local transform get recomputed
+class HierarchySystem : public System {
+private:
+	struct Node {
+		Entity entity = Entity(0);
+		int parent = -1; // index of the parent node, -1 for the roots (parents without a parent)
+		int depth = 0;
+		bool isDirty = true;
+		LocalTransformComponent local; // only used by children
+		TransformComponent world;
+	};
+
+	std::vector<Node> nodes; // sorted by depth
+	std::vector<int> nodeIndices; // [entity id] = index in nodes or -1
+	uint32_t membershipVersion = 0; // of the children the nodes were built from
+	uint32_t parentVersion = 0;
+	uint32_t localVersion = 0;
+	uint32_t transformVersion = 0;
+	bool needsRebuild = true;
+
+	static TransformComponent Combine(const TransformComponent& parent, const LocalTransformComponent& local) {
+		const double angle = glm::radians(parent.rotation);
+		const glm::vec2 offset = local.position * parent.scale;
+		const float cosAngle = static_cast<float>(std::cos(angle));
+		const float sinAngle = static_cast<float>(std::sin(angle));
+		return TransformComponent(
+			parent.position + glm::vec2(offset.x * cosAngle - offset.y * sinAngle, offset.x * sinAngle + offset.y * cosAngle),
+			parent.scale * local.scale,
+			parent.rotation + local.rotation
+		);
+	}
+
+	int GetNodeIndex(int entityId) const {
+		return entityId < nodeIndices.size() ? nodeIndices[entityId] : -1;
+	}
+
+	// sorts the hierarchy again, only needed when parents were added, removed or killed
+	void Rebuild() {
+		const Registry& constRegistry = *registry;
+		const Span<const Entity> children = GetSystemEnties();
+
+		// the children first, then the roots they are attached to
+		std::vector<Node> unsorted;
+		unsorted.reserve(children.GetSize() * 2);
+		std::fill(nodeIndices.begin(), nodeIndices.end(), -1);
+		auto addNode = [&](Entity entity) {
+			if (entity.GetId() >= nodeIndices.size()) {
+				nodeIndices.resize(entity.GetId() + 1, -1);
+			}
+			nodeIndices[entity.GetId()] = static_cast<int>(unsorted.size());
+			Node node;
+			node.entity = entity;
+			node.world = constRegistry.GetComponent<TransformComponent>(entity);
+			unsorted.push_back(node);
+		};
+		for (Entity child : children) {
+			addNode(child);
+		}
+		for (size_t i = 0; i < children.GetSize(); i++) {
+			Entity parent = constRegistry.GetComponent<ParentComponent>(children[i]).parent;
+			// a child of a dead parent (or of a parent without a transform) stays where it is
+			if (!registry->IsAlive(parent) || !registry->HasComponent<TransformComponent>(parent)) {
+				continue;
+			}
+			if (GetNodeIndex(parent.GetId()) == -1) {
+				addNode(parent);
+			}
+			unsorted[i].parent = GetNodeIndex(parent.GetId());
+			unsorted[i].local = constRegistry.GetComponent<LocalTransformComponent>(children[i]);
+		}
+
+		// depth = length of the chain up to the root (-1 = unknown, -2 = on the current chain)
+		// a cycle gets cut by turning the node where it closes into a root
+		for (Node& node : unsorted) {
+			node.depth = node.parent == -1 ? 0 : -1;
+		}
+		std::vector<int> chain;
+		for (size_t i = 0; i < unsorted.size(); i++) {
+			chain.clear();
+			int current = static_cast<int>(i);
+			while (unsorted[current].depth == -1) {
+				unsorted[current].depth = -2;
+				chain.push_back(current);
+				current = unsorted[current].parent;
+			}
+			if (unsorted[current].depth == -2) {
+				unsorted[current].parent = -1;
+				unsorted[current].depth = 0;
+			}
+			for (auto node = chain.rbegin(); node != chain.rend(); ++node) {
+				if (unsorted[*node].parent != -1) {
+					unsorted[*node].depth = unsorted[unsorted[*node].parent].depth + 1;
+				}
+			}
+		}
+
+		std::vector<int> order(unsorted.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			order[i] = static_cast<int>(i);
+		}
+		std::stable_sort(order.begin(), order.end(), [&unsorted](int a, int b) {
+			return unsorted[a].depth < unsorted[b].depth;
+		});
+
+		nodes.clear();
+		nodes.reserve(unsorted.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			nodeIndices[unsorted[order[i]].entity.GetId()] = static_cast<int>(i);
+		}
+		for (int index : order) {
+			Node node = unsorted[index];
+			if (node.parent != -1) {
+				node.parent = nodeIndices[unsorted[node.parent].entity.GetId()];
+			}
+			nodes.push_back(node);
+		}
+
+		membershipVersion = GetMembershipVersion();
+		needsRebuild = false;
+	}
+
+public:
+	HierarchySystem() {
+		RequireComponent<TransformComponent>();
+		RequireComponent<LocalTransformComponent>(ComponentAccess::Read);
+		RequireComponent<ParentComponent>(ComponentAccess::Read);
+	}
+
+	void Update(double deltaTime) {
+		// a killed child and a new one in the same frame keep the amount of children, not the membership version
+		if (registry->GetVersion<ParentComponent>() != parentVersion || GetMembershipVersion() != membershipVersion) {
+			needsRebuild = true;
+		}
+
+		if (needsRebuild) {
+			Rebuild();
+		}
+		else {
+			// moved roots and changed local transforms make their subtrees dirty
+			for (auto [entity, transform] : registry->ViewChanged<TransformComponent>(transformVersion)) {
+				const int index = GetNodeIndex(entity.GetId());
+				if (index != -1 && nodes[index].parent == -1) {
+					nodes[index].world = transform;
+					nodes[index].isDirty = true;
+				}
+			}
+			for (auto [entity, local] : registry->ViewChanged<LocalTransformComponent>(localVersion)) {
+				const int index = GetNodeIndex(entity.GetId());
+				if (index != -1 && nodes[index].parent != -1) {
+					nodes[index].local = local;
+					nodes[index].isDirty = true;
+				}
+			}
+		}
+
+		// all the children moved by this pass share one version
+		const uint32_t version = registry->NewVersion<TransformComponent>();
+		// parents come first, so a dirty parent is already up to date when its children get computed
+		for (Node& node : nodes) {
+			if (node.parent == -1) {
+				if (!registry->IsAlive(node.entity)) {
+					needsRebuild = true;
+				}
+				continue;
+			}
+			const Node& parent = nodes[node.parent];
+			if (!parent.isDirty && !node.isDirty) {
+				continue;
+			}
+			node.isDirty = true;
+			node.world = Combine(parent.world, node.local);
+			// the previous transform stays, the InterpolationSystem keeps it
+			TransformComponent& transform = registry->GetComponentUnmarked<TransformComponent>(node.entity);
+			transform.position = node.world.position;
+			transform.scale = node.world.scale;
+			transform.rotation = node.world.rotation;
+			registry->MarkChanged<TransformComponent>(node.entity, version);
+		}
+		for (Node& node : nodes) {
+			node.isDirty = false;
+		}
+
+		parentVersion = registry->GetVersion<ParentComponent>();
+		localVersion = registry->GetVersion<LocalTransformComponent>();
+		transformVersion = registry->GetVersion<TransformComponent>();
+	}
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+
+// remembers the transforms before each simulation step, so the renderer can draw between the last two steps
+// only the transforms which changed in the step before (ViewChanged) need a copy, the others are still the same
+// has to be scheduled before every system which moves entities
+class InterpolationSystem : public System {
+private:
+	uint32_t transformVersion = 0;
+
+public:
+	InterpolationSystem() {
+		RequireComponent<TransformComponent>();
+	}
+
+	void Update(double deltaTime) {
+		// writes no current transform, so the copies don't count as changes
+		for (auto [entity, transform] : registry->ViewChanged<TransformComponent>(transformVersion)) {
+			transform.previousPosition = transform.position;
+			transform.previousRotation = transform.rotation;
+		}
+		transformVersion = registry->GetVersion<TransformComponent>();
+	}
+};
\ No newline at end of file
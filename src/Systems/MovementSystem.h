@@ -10,23 +10,53 @@ class MovementSystem : public System {
 public:
 	MovementSystem() {
 		RequireComponent<TransformComponent>();
-		RequireComponent<RigidBodyComponent>();
+		RequireComponent<RigidBodyComponent>(ComponentAccess::Read);
 	}
 
 	void Update(double deltaTime) {
-		for (auto entity : GetSystemEnties()) {
-			TransformComponent& transform = entity.GetComponent<TransformComponent>();
-			const RigidBodyComponent rigidBody = entity.GetComponent<RigidBodyComponent>();
+		if (GetSystemEnties().IsEmpty()) {
+			return;
+		}
+
+		// only the transforms which really move count as changed, so static entities
+		// don't show up in ViewChanged<TransformComponent>()
+		const uint32_t version = registry->NewVersion<TransformComponent>();
+		Registry* registry = this->registry;
+
+		if (IsParallel() && registry->GetJobSystem()) {
+			registry->View<TransformComponent, RigidBodyComponent>().ParallelEach(*registry->GetJobSystem(), [deltaTime, version, registry](Entity entity, TransformComponent& transform, RigidBodyComponent& rigidBody) {
+				if (rigidBody.velocity.x != 0.0 || rigidBody.velocity.y != 0.0) {
+					transform.position.x += rigidBody.velocity.x * deltaTime;
+					transform.position.y += rigidBody.velocity.y * deltaTime;
+					registry->MarkChanged<TransformComponent>(entity, version);
+				}
+			});
+			return;
+		}
+
+		// with archetypes the transforms and rigid bodies lie next to each other in the chunks
+		if (registry->GetStorageMode() == StorageMode::Archetypes) {
+			registry->ForEachChunk<TransformComponent, RigidBodyComponent>([deltaTime, version, registry](int count, const int* entityIds, TransformComponent* transforms, RigidBodyComponent* rigidBodies) {
+				for (int i = 0; i < count; i++) {
+					if (rigidBodies[i].velocity.x != 0.0 || rigidBodies[i].velocity.y != 0.0) {
+						transforms[i].position.x += rigidBodies[i].velocity.x * deltaTime;
+						transforms[i].position.y += rigidBodies[i].velocity.y * deltaTime;
+						registry->MarkChanged<TransformComponent>(Entity(entityIds[i]), version);
+					}
+				}
+			});
+			return;
+		}
 
+		for (auto [entity, transform, rigidBody] : registry->View<TransformComponent, RigidBodyComponent>()) {
+			if (rigidBody.velocity.x == 0.0 && rigidBody.velocity.y == 0.0) {
+				continue;
+			}
 			transform.position.x += rigidBody.velocity.x * deltaTime;
 			transform.position.y += rigidBody.velocity.y * deltaTime;
+			registry->MarkChanged<TransformComponent>(entity, version);
 
-			/*Logger::trace(
-				"Entity id = " + std::to_string(entity.GetId())
-				+ " position is now ("
-				+ std::to_string(transform.position.x) + ", "
-				+ std::to_string(transform.position.y) + ")"
-			);*/
+			/*LOG_TRACE(ECS, "Entity id = {} position is now ({}, {})", entity.GetId(), transform.position.x, transform.position.y);*/
 		}
 	}
 };
\ No newline at end of file
@@ -1,40 +1,199 @@
 #pragma once
 
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
+#include "../Components/CameraComponent.h"
 #include "../ECS/ECS.h"
 #include "../Logger/Logger.h"
+#include "../AssetManager/AssetHandler.h"
+#include "../Renderer/RenderCommandList.h"
+#include "../Renderer/RadixSort.h"
+#include "../Spatial/SpatialGrid.h"
 #include <SDL.h>
 
+// records the sprites the camera sees for the RenderBackend
+// the sprites are kept in a spatial grid which only gets updated for moved or changed sprites (ViewChanged),
+// so each frame only the sprites in the cells around the camera cost anything, no matter how big the map is
+// the visible sprites get drawn in the order of their render keys (layer, z index, texture), sorted with a radix sort
+// the sprites and the camera get drawn between their last two simulation steps (alpha), so the motion is smooth
+// whether the display shows more or fewer frames than the simulation steps
 class RenderingSystem : public System {
+private:
+	static constexpr float GRID_CELL_SIZE = 256.0f;
+
+	SpatialGrid grid = SpatialGrid(GRID_CELL_SIZE);
+	uint32_t transformVersion = 0;
+	uint32_t spriteVersion = 0;
+	std::vector<int> visibleIds; // kept over the frames so it doesn't get allocated again
+	std::vector<int> removedIds;
+
+	// render key of a visible sprite, sorted from the high to the low bits:
+	// layer (8 bits) | z index (16) | texture (16) | entity id (24)
+	// so the layers and z indices overlap right, and equal ones get grouped by texture for the sprite batch
+	struct SortItem {
+		uint64_t key;
+		uint32_t drawItem;
+	};
+	// kept over the frames so they don't get allocated again
+	std::vector<SpriteQuad> drawItems;
+	std::vector<SortItem> sortItems;
+	std::vector<SortItem> sortBuffer;
+	// index = texture bits of the render keys, stays the same over the frames so overlapping sprites don't flicker
+	std::vector<SDL_Texture*> textureIds;
+	size_t lastTextureId = 0;
+
+	// the texture of the last sprite outside the atlas, most sprites in a row use the same one
+	const std::string* lastAssetId = nullptr;
+	SDL_Texture* lastTexture = nullptr;
+
+	// rectangle around the sprite in world coordinates, a rotated sprite gets the square around its circle
+	static SDL_FRect GetBounds(const TransformComponent& transform, const SpriteComponent& sprite) {
+		const float width = static_cast<float>(sprite.width * transform.scale.x);
+		const float height = static_cast<float>(sprite.height * transform.scale.y);
+		if (transform.rotation == 0.0) {
+			return { transform.position.x, transform.position.y, width, height };
+		}
+		const float radius = 0.5f * std::sqrt(width * width + height * height);
+		const float centerX = transform.position.x + width * 0.5f;
+		const float centerY = transform.position.y + height * 0.5f;
+		return { centerX - radius, centerY - radius, radius * 2.0f, radius * 2.0f };
+	}
+
+	static bool Overlaps(const SDL_FRect& a, const SDL_FRect& b) {
+		return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+	}
+
+	// puts the sprites which were added, moved or changed since the last frame into their cells
+	void UpdateGrid() {
+		const Registry& constRegistry = *registry;
+		for (auto [entity, transform] : registry->ViewChanged<TransformComponent>(transformVersion)) {
+			if (HasEntity(entity)) {
+				grid.Insert(entity.GetId(), GetBounds(transform, constRegistry.GetComponent<SpriteComponent>(entity)));
+			}
+		}
+		for (auto [entity, sprite] : registry->ViewChanged<SpriteComponent>(spriteVersion)) {
+			if (HasEntity(entity)) {
+				grid.Insert(entity.GetId(), GetBounds(constRegistry.GetComponent<TransformComponent>(entity), sprite));
+			}
+		}
+		transformVersion = registry->GetVersion<TransformComponent>();
+		spriteVersion = registry->GetVersion<SpriteComponent>();
+	}
+
+	uint64_t GetTextureBits(SDL_Texture* texture) {
+		if (lastTextureId < textureIds.size() && textureIds[lastTextureId] == texture) {
+			return lastTextureId;
+		}
+		// only a few textures, a linear search is faster than hashing
+		const size_t index = std::find(textureIds.begin(), textureIds.end(), texture) - textureIds.begin();
+		// the render key has 16 bits for the texture, the textures after that share the last id
+		if (index == textureIds.size() && textureIds.size() <= 0xFFFF) {
+			textureIds.push_back(texture);
+		}
+		lastTextureId = std::min<size_t>(index, 0xFFFF);
+		return lastTextureId;
+	}
+
+	static uint64_t GetRenderKey(const SpriteComponent& sprite, uint64_t textureBits, int entityId) {
+		const uint64_t layerBits = static_cast<uint64_t>(std::clamp(sprite.layer, 0, 255));
+		const uint64_t zIndexBits = static_cast<uint64_t>(std::clamp(sprite.zIndex, -32768, 32767) + 32768);
+		return layerBits << 56 | zIndexBits << 40 | textureBits << 24 | (static_cast<uint64_t>(entityId) & 0xFFFFFF);
+	}
+
+	void AddSprite(std::unique_ptr<AssetHandler>& assetHandler, const CameraComponent& camera, int entityId, const TransformComponent& transform, const SpriteComponent& sprite) {
+		SDL_Texture* texture = nullptr;
+		SDL_Rect srcRect = sprite.srcRect;
+		if (sprite.atlasPage >= 0) {
+			// the sprites of all the images of a page end up in the same batch
+			texture = assetHandler->GetAtlasPage(sprite.atlasPage);
+			srcRect.x += sprite.atlasRect.x;
+			srcRect.y += sprite.atlasRect.y;
+		}
+		else {
+			if (!lastAssetId || *lastAssetId != sprite.assetId) {
+				lastAssetId = &sprite.assetId;
+				lastTexture = assetHandler->GetTexture(sprite.assetId);
+			}
+			texture = lastTexture;
+		}
+		if (!texture) {
+			return;
+		}
+
+		SDL_FRect dstRect = {
+			(transform.position.x - camera.position.x) * camera.zoom,
+			(transform.position.y - camera.position.y) * camera.zoom,
+			static_cast<float>(sprite.width * transform.scale.x * camera.zoom),
+			static_cast<float>(sprite.height * transform.scale.y * camera.zoom)
+		};
+
+		sortItems.push_back({ GetRenderKey(sprite, GetTextureBits(texture), entityId), static_cast<uint32_t>(drawItems.size()) });
+		drawItems.push_back({ texture, srcRect, dstRect, transform.rotation });
+	}
+
 public:
 	RenderingSystem() {
-		RequireComponent<TransformComponent>();
-		RequireComponent<SpriteComponent>();
-	}
-
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetHandler>& assetHandler) {
-		for (auto entity : GetSystemEnties()) {
-			const TransformComponent transform = entity.GetComponent<TransformComponent>();
-			const SpriteComponent sprite = entity.GetComponent<SpriteComponent>();
-
-			SDL_Rect srcRect = sprite.srcRect;
-			SDL_Rect dstRect = {
-				transform.position.x,
-				transform.position.y,
-				sprite.width * transform.scale.x,
-				sprite.height * transform.scale.y
-			};
-			
-			SDL_RenderCopyEx(
-				renderer,
-				assetHandler->GetTexture(sprite.assetId),
-				&srcRect,
-				&dstRect,
-				transform.rotation,
-				NULL,
-				SDL_FLIP_NONE
-			);
-		}
-	}
-};
+		RequireComponent<TransformComponent>(ComponentAccess::Read);
+		RequireComponent<SpriteComponent>(ComponentAccess::Read);
+		UseComponent<CameraComponent>(ComponentAccess::Read);
+	}
+
+	// the first camera between its last two steps, without one the viewport shows the world from (0, 0)
+	CameraComponent GetCamera(int viewportWidth, int viewportHeight, float alpha) const {
+		for (auto [entity, camera] : registry->View<CameraComponent>()) {
+			CameraComponent interpolated = camera;
+			interpolated.position = glm::mix(camera.previousPosition, camera.position, alpha);
+			return interpolated;
+		}
+		return CameraComponent(viewportWidth, viewportHeight);
+	}
+
+	// collects the sprites the camera sees, sorts them by their render keys and records them for the RenderBackend,
+	// whose sprite batch draws each run of sprites with the same texture with one call
+	void Update(RenderCommandList& commands, const CameraComponent& camera, std::unique_ptr<AssetHandler>& assetHandler, float alpha) {
+		UpdateGrid();
+
+		const SDL_FRect view = camera.GetWorldRect();
+		visibleIds.clear();
+		grid.Query(view, visibleIds);
+
+		drawItems.clear();
+		sortItems.clear();
+		lastAssetId = nullptr;
+
+		const Registry& constRegistry = *registry;
+		removedIds.clear();
+		for (int entityId : visibleIds) {
+			const Entity entity(entityId);
+			// killed entities and entities which lost a component leave the grid once they are seen
+			if (!HasEntity(entity)) {
+				removedIds.push_back(entityId);
+				continue;
+			}
+			// the grid has the bounds of the last step, the sprite is at most one step behind them
+			const TransformComponent transform = constRegistry.GetComponent<TransformComponent>(entity).Interpolate(alpha);
+			const SpriteComponent& sprite = constRegistry.GetComponent<SpriteComponent>(entity);
+			if (Overlaps(GetBounds(transform, sprite), view)) {
+				AddSprite(assetHandler, camera, entityId, transform, sprite);
+			}
+		}
+		for (int entityId : removedIds) {
+			grid.Remove(entityId);
+		}
+
+		// the cells return the sprites in any order, the entity id in the keys keeps the order stable
+		RadixSort(sortItems, sortBuffer);
+
+		for (const SortItem& item : sortItems) {
+			commands.AddSprite(drawItems[item.drawItem]);
+		}
+	}
+
+	const SpatialGrid& GetSpatialGrid() const {
+		return grid;
+	}
+};
\ No newline at end of file
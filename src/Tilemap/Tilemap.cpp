@@ -0,0 +1,118 @@
+#include "Tilemap.h"
+#include <algorithm>
+
+Tilemap::Tilemap(int width, int height, int tileSize, float tileScale, const std::string& tilesetId, int tilesetColumns, int numLayers)
+	: width(width), height(height), tileSize(tileSize), tileScale(tileScale), tilesetId(tilesetId), tilesetColumns(tilesetColumns) {
+	const size_t layerSize = static_cast<size_t>(width) * height;
+	ownedTiles.assign(layerSize * numLayers, EMPTY_TILE);
+	for (int i = 0; i < numLayers; i++) {
+		layers.push_back({ "layer" + std::to_string(i), ownedTiles.data() + layerSize * i });
+	}
+	numChunksX = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+	numChunksY = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+	chunkVersions.assign(static_cast<size_t>(numChunksX) * numChunksY, 0);
+}
+
+Tilemap::Tilemap(int width, int height, int tileSize, float tileScale, const std::string& tilesetId, const std::string& tilesetPath, int tilesetColumns,
+	std::unique_ptr<MappedFile> file, const std::vector<Layer>& layers)
+	: width(width), height(height), tileSize(tileSize), tileScale(tileScale), tilesetId(tilesetId), tilesetPath(tilesetPath), tilesetColumns(tilesetColumns),
+	layers(layers), file(std::move(file)) {
+	numChunksX = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+	numChunksY = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+	chunkVersions.assign(static_cast<size_t>(numChunksX) * numChunksY, 0);
+}
+
+int Tilemap::GetWidth() const {
+	return width;
+}
+
+int Tilemap::GetHeight() const {
+	return height;
+}
+
+int Tilemap::GetTileSize() const {
+	return tileSize;
+}
+
+float Tilemap::GetTileScale() const {
+	return tileScale;
+}
+
+float Tilemap::GetWorldTileSize() const {
+	return tileSize * tileScale;
+}
+
+const std::string& Tilemap::GetTilesetId() const {
+	return tilesetId;
+}
+
+const std::string& Tilemap::GetTilesetPath() const {
+	return tilesetPath;
+}
+
+int Tilemap::GetTilesetColumns() const {
+	return tilesetColumns;
+}
+
+int Tilemap::GetNumLayers() const {
+	return static_cast<int>(layers.size());
+}
+
+const std::string& Tilemap::GetLayerName(int layer) const {
+	return layers[layer].name;
+}
+
+uint16_t Tilemap::GetTile(int x, int y, int layer) const {
+	if (x < 0 || y < 0 || x >= width || y >= height) {
+		return EMPTY_TILE;
+	}
+	return layers[layer].tiles[static_cast<size_t>(y) * width + x];
+}
+
+void Tilemap::SetTile(int x, int y, uint16_t tile, int layer) {
+	if (x < 0 || y < 0 || x >= width || y >= height) {
+		return;
+	}
+	// a loaded map is mapped copy on write, only the written page gets copied
+	uint16_t& current = layers[layer].tiles[static_cast<size_t>(y) * width + x];
+	if (current == tile) {
+		return;
+	}
+	current = tile;
+	chunkVersions[static_cast<size_t>(y / CHUNK_TILES) * numChunksX + x / CHUNK_TILES]++;
+}
+
+SDL_Rect Tilemap::GetTileRect(uint16_t tile) const {
+	return { (tile % tilesetColumns) * tileSize, (tile / tilesetColumns) * tileSize, tileSize, tileSize };
+}
+
+int Tilemap::GetNumChunksX() const {
+	return numChunksX;
+}
+
+int Tilemap::GetNumChunksY() const {
+	return numChunksY;
+}
+
+uint32_t Tilemap::GetChunkVersion(int chunkX, int chunkY) const {
+	return chunkVersions[static_cast<size_t>(chunkY) * numChunksX + chunkX];
+}
+
+SDL_Rect Tilemap::GetChunkTiles(int chunkX, int chunkY) const {
+	const int x = chunkX * CHUNK_TILES;
+	const int y = chunkY * CHUNK_TILES;
+	return { x, y, std::min(CHUNK_TILES, width - x), std::min(CHUNK_TILES, height - y) };
+}
+
+bool Tilemap::IsChunkEmpty(int chunkX, int chunkY) const {
+	const SDL_Rect chunk = GetChunkTiles(chunkX, chunkY);
+	for (const Layer& layer : layers) {
+		for (int y = chunk.y; y < chunk.y + chunk.h; y++) {
+			const uint16_t* row = &layer.tiles[static_cast<size_t>(y) * width + chunk.x];
+			if (std::any_of(row, row + chunk.w, [](uint16_t tile) { return tile != EMPTY_TILE; })) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <SDL.h>
+#include "../AssetManager/MappedFile.h"
+
+// the tiles of a map as indices into a tileset, one flat array per layer, instead of an entity per tile
+// the layers are drawn on top of each other in order
+// the map is split into chunks of CHUNK_TILES x CHUNK_TILES tiles, changing a tile
+// bumps the version of its chunk so the TilemapRenderer knows which baked chunks are outdated
+class Tilemap {
+public:
+	static constexpr int CHUNK_TILES = 32; // tiles per side of a chunk
+	static constexpr uint16_t EMPTY_TILE = 0xFFFF;
+
+	struct Layer {
+		std::string name;
+		uint16_t* tiles; // [y * width + x] = index in the tileset (row by row) or EMPTY_TILE
+	};
+
+private:
+	int width; // in tiles
+	int height;
+	int tileSize; // in pixels of the tileset
+	float tileScale; // size of a tile in the world = tileSize * tileScale
+	std::string tilesetId; // asset id of the tileset texture
+	std::string tilesetPath; // image of the tileset, empty for maps created in code
+	int tilesetColumns; // tiles per row of the tileset
+
+	std::vector<Layer> layers;
+	std::vector<uint16_t> ownedTiles; // the tiles of all the layers of a map created in code
+	std::unique_ptr<MappedFile> file; // or the file the layers of a loaded map point into (copy on write)
+	int numChunksX;
+	int numChunksY;
+	std::vector<uint32_t> chunkVersions; // [chunk y * numChunksX + chunk x] = changes of the tiles of the chunk
+
+public:
+	// an empty map
+	Tilemap(int width, int height, int tileSize, float tileScale, const std::string& tilesetId, int tilesetColumns, int numLayers = 1);
+	// a map whose layers point into a mapped file, see TilemapFile::Load()
+	Tilemap(int width, int height, int tileSize, float tileScale, const std::string& tilesetId, const std::string& tilesetPath, int tilesetColumns,
+		std::unique_ptr<MappedFile> file, const std::vector<Layer>& layers);
+	Tilemap(const Tilemap&) = delete;
+	Tilemap& operator =(const Tilemap&) = delete;
+
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetTileSize() const;
+	float GetTileScale() const;
+	// size of a tile in world coordinates
+	float GetWorldTileSize() const;
+	const std::string& GetTilesetId() const;
+	const std::string& GetTilesetPath() const;
+	int GetTilesetColumns() const;
+
+	int GetNumLayers() const;
+	const std::string& GetLayerName(int layer) const;
+	uint16_t GetTile(int x, int y, int layer = 0) const;
+	void SetTile(int x, int y, uint16_t tile, int layer = 0);
+	// rectangle of the tile in the tileset
+	SDL_Rect GetTileRect(uint16_t tile) const;
+
+	int GetNumChunksX() const;
+	int GetNumChunksY() const;
+	uint32_t GetChunkVersion(int chunkX, int chunkY) const;
+	// the tiles of the chunk in tile coordinates, the chunks at the right and bottom edge can be smaller
+	SDL_Rect GetChunkTiles(int chunkX, int chunkY) const;
+	// true if no layer has a tile to draw in the chunk
+	bool IsChunkEmpty(int chunkX, int chunkY) const;
+};
@@ -0,0 +1,309 @@
+#include "TilemapFile.h"
+#include "../Logger/Logger.h"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+namespace {
+	struct SourceLayer {
+		std::string name;
+		std::vector<uint16_t> tiles;
+		int width = 0;
+		int height = 0;
+	};
+
+	std::string_view Trim(std::string_view text) {
+		while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+			text.remove_prefix(1);
+		}
+		while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+			text.remove_suffix(1);
+		}
+		return text;
+	}
+
+	// splits off the next word (separated by whitespace)
+	std::string NextWord(std::string_view& line) {
+		line = Trim(line);
+		size_t end = 0;
+		while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end]))) {
+			end++;
+		}
+		std::string word(line.substr(0, end));
+		line.remove_prefix(end);
+		return word;
+	}
+
+	// appends the comma separated tile indices of a row, false if a cell is no valid index
+	bool ParseRow(std::string_view line, std::vector<uint16_t>& tiles, int& count) {
+		count = 0;
+		while (true) {
+			const size_t comma = line.find(',');
+			const std::string_view cell = Trim(line.substr(0, comma));
+			if (cell.empty() || cell == "-1") {
+				tiles.push_back(Tilemap::EMPTY_TILE);
+			}
+			else {
+				uint32_t value = 0;
+				for (char ch : cell) {
+					if (ch < '0' || ch > '9' || value >= Tilemap::EMPTY_TILE) {
+						return false;
+					}
+					value = value * 10 + (ch - '0');
+				}
+				if (value >= Tilemap::EMPTY_TILE) {
+					return false;
+				}
+				tiles.push_back(static_cast<uint16_t>(value));
+			}
+			count++;
+			if (comma == std::string_view::npos) {
+				return true;
+			}
+			line.remove_prefix(comma + 1);
+		}
+	}
+
+	uint64_t AlignUp(uint64_t offset) {
+		return (offset + TilemapFile::DATA_ALIGNMENT - 1) / TilemapFile::DATA_ALIGNMENT * TilemapFile::DATA_ALIGNMENT;
+	}
+
+	void CopyName(char* target, size_t capacity, const std::string& name) {
+		std::memset(target, 0, capacity);
+		std::memcpy(target, name.data(), std::min(name.size(), capacity - 1));
+	}
+}
+
+bool TilemapFile::Compile(const std::string& sourcePath, const std::string& targetPath) {
+	std::ifstream source(sourcePath, std::ios::binary);
+	if (!source) {
+		LOG_ERROR(Assets, "Error opening the tilemap \"{}\"", sourcePath);
+		return false;
+	}
+	std::ostringstream buffer;
+	buffer << source.rdbuf();
+	const std::string text = buffer.str();
+
+	std::string tilesetId;
+	std::string tilesetPath;
+	int tileSize = 0;
+	int tilesetColumns = 0;
+	float tileScale = 1.0f;
+	std::vector<SourceLayer> layers;
+
+	int lineNumber = 0;
+	auto fail = [&](const char* message) {
+		LOG_ERROR(Assets, "Error compiling the tilemap \"{}\" line {}: {}", sourcePath, lineNumber, message);
+		return false;
+	};
+
+	size_t lineStart = 0;
+	while (lineStart < text.size()) {
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string::npos) {
+			lineEnd = text.size();
+		}
+		std::string_view line = Trim(std::string_view(text).substr(lineStart, lineEnd - lineStart));
+		lineStart = lineEnd + 1;
+		lineNumber++;
+
+		if (line.empty() || line.front() == '#') {
+			continue;
+		}
+
+		if (std::isalpha(static_cast<unsigned char>(line.front()))) {
+			const std::string directive = NextWord(line);
+			if (directive == "tileset") {
+				tilesetId = NextWord(line);
+				tilesetPath = NextWord(line);
+				tileSize = std::atoi(NextWord(line).c_str());
+				tilesetColumns = std::atoi(NextWord(line).c_str());
+				if (tilesetId.empty() || tilesetPath.empty() || tileSize <= 0 || tilesetColumns <= 0) {
+					return fail("expected: tileset <asset id> <image path> <tile size> <tiles per row>");
+				}
+				if (tilesetId.size() >= MAX_NAME_LENGTH || tilesetPath.size() >= MAX_PATH_LENGTH) {
+					return fail("the tileset id or path is too long");
+				}
+			}
+			else if (directive == "scale") {
+				tileScale = static_cast<float>(std::atof(NextWord(line).c_str()));
+				if (tileScale <= 0.0f) {
+					return fail("expected: scale <tile scale>");
+				}
+			}
+			else if (directive == "layer") {
+				SourceLayer layer;
+				layer.name = NextWord(line);
+				if (layer.name.empty() || layer.name.size() >= MAX_NAME_LENGTH) {
+					return fail("expected: layer <name>");
+				}
+				layers.push_back(std::move(layer));
+			}
+			else {
+				return fail("unknown directive");
+			}
+			continue;
+		}
+
+		// rows before the first layer directive belong to a default layer
+		if (layers.empty()) {
+			SourceLayer ground;
+			ground.name = "ground";
+			ground.width = 0;
+			ground.height = 0;
+			layers.push_back(std::move(ground));
+		}
+		SourceLayer& layer = layers.back();
+		int count = 0;
+		if (!ParseRow(line, layer.tiles, count)) {
+			return fail("a tile is no index between 0 and 65534 (or -1)");
+		}
+		if (layer.height == 0) {
+			layer.width = count;
+		}
+		else if (count != layer.width) {
+			return fail("the row has a different number of tiles than the first row of the layer");
+		}
+		layer.height++;
+	}
+
+	if (tilesetId.empty()) {
+		return fail("no tileset");
+	}
+	if (layers.empty() || layers.front().height == 0) {
+		return fail("no tiles");
+	}
+	for (const SourceLayer& layer : layers) {
+		if (layer.width != layers.front().width || layer.height != layers.front().height) {
+			LOG_ERROR(Assets, "Error compiling the tilemap \"{}\": the layer \"{}\" has a different size than the first one", sourcePath, layer.name);
+			return false;
+		}
+	}
+
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.byteOrderMark = BYTE_ORDER_MARK;
+	header.width = layers.front().width;
+	header.height = layers.front().height;
+	header.tileSize = tileSize;
+	header.tileScale = tileScale;
+	header.tilesetColumns = tilesetColumns;
+	header.numLayers = static_cast<uint32_t>(layers.size());
+	header.layersOffset = sizeof(Header);
+	CopyName(header.tilesetId, MAX_NAME_LENGTH, tilesetId);
+	CopyName(header.tilesetPath, MAX_PATH_LENGTH, tilesetPath);
+
+	const uint64_t layerBytes = static_cast<uint64_t>(header.width) * header.height * sizeof(uint16_t);
+	std::vector<LayerEntry> entries(layers.size());
+	uint64_t offset = AlignUp(header.layersOffset + sizeof(LayerEntry) * entries.size());
+	for (size_t i = 0; i < layers.size(); i++) {
+		CopyName(entries[i].name, MAX_NAME_LENGTH, layers[i].name);
+		entries[i].tilesOffset = offset;
+		offset = AlignUp(offset + layerBytes);
+	}
+	header.fileSize = offset;
+
+	std::ofstream target(targetPath, std::ios::binary | std::ios::trunc);
+	if (!target) {
+		LOG_ERROR(Assets, "Error creating the tilemap \"{}\"", targetPath);
+		return false;
+	}
+	const char padding[DATA_ALIGNMENT] = {};
+	target.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	target.write(reinterpret_cast<const char*>(entries.data()), sizeof(LayerEntry) * entries.size());
+	for (size_t i = 0; i < layers.size(); i++) {
+		target.write(padding, static_cast<std::streamsize>(entries[i].tilesOffset - static_cast<uint64_t>(target.tellp())));
+		target.write(reinterpret_cast<const char*>(layers[i].tiles.data()), static_cast<std::streamsize>(layerBytes));
+	}
+	target.write(padding, static_cast<std::streamsize>(header.fileSize - static_cast<uint64_t>(target.tellp())));
+	if (!target) {
+		LOG_ERROR(Assets, "Error writing the tilemap \"{}\"", targetPath);
+		return false;
+	}
+
+	LOG_INFO(Assets, "Compiled the tilemap \"{}\" into \"{}\" ({}x{} tiles, {} layers)", sourcePath, targetPath, header.width, header.height, header.numLayers);
+	return true;
+}
+
+bool TilemapFile::IsOutdated(const std::string& sourcePath, const std::string& targetPath) {
+	std::error_code error;
+	if (!std::filesystem::exists(targetPath, error)) {
+		return true;
+	}
+	// only the binary map is there (a shipped game)
+	if (!std::filesystem::exists(sourcePath, error)) {
+		return false;
+	}
+	return std::filesystem::last_write_time(sourcePath, error) > std::filesystem::last_write_time(targetPath, error);
+}
+
+std::unique_ptr<Tilemap> TilemapFile::Load(const std::string& filePath) {
+	std::unique_ptr<MappedFile> file = MappedFile::Open(filePath);
+	if (!file) {
+		return nullptr;
+	}
+	auto invalid = [&filePath](const char* reason) {
+		LOG_ERROR(Assets, "The tilemap \"{}\" is invalid: {}", filePath, reason);
+		return nullptr;
+	};
+
+	// only the header and the layer table get read, the tiles are used where they are
+	std::byte* data = static_cast<std::byte*>(file->GetData());
+	const uint64_t size = file->GetSize();
+	if (size < sizeof(Header)) {
+		return invalid("too small");
+	}
+	Header header;
+	std::memcpy(&header, data, sizeof(Header));
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+		return invalid("no tilemap file");
+	}
+	if (header.version != VERSION) {
+		return invalid("unsupported version, compile it again");
+	}
+	if (header.byteOrderMark != BYTE_ORDER_MARK) {
+		return invalid("compiled on a machine with a different byte order");
+	}
+	if (header.fileSize != size) {
+		return invalid("the file was cut off");
+	}
+	if (header.width == 0 || header.height == 0 || header.width > INT32_MAX / header.height || header.tileSize == 0 || header.tilesetColumns == 0 || header.numLayers == 0) {
+		return invalid("bad dimensions");
+	}
+	if (!std::memchr(header.tilesetId, '\0', MAX_NAME_LENGTH) || !std::memchr(header.tilesetPath, '\0', MAX_PATH_LENGTH)) {
+		return invalid("bad tileset");
+	}
+	if (header.layersOffset > size || header.numLayers > (size - header.layersOffset) / sizeof(LayerEntry)) {
+		return invalid("bad layer table");
+	}
+
+	const uint64_t layerBytes = static_cast<uint64_t>(header.width) * header.height * sizeof(uint16_t);
+	std::vector<Tilemap::Layer> layers;
+	layers.reserve(header.numLayers);
+	for (uint32_t i = 0; i < header.numLayers; i++) {
+		LayerEntry entry;
+		std::memcpy(&entry, data + header.layersOffset + i * sizeof(LayerEntry), sizeof(LayerEntry));
+		if (entry.tilesOffset % alignof(uint16_t) != 0 || entry.tilesOffset > size || layerBytes > size - entry.tilesOffset) {
+			return invalid("bad layer");
+		}
+		if (!std::memchr(entry.name, '\0', MAX_NAME_LENGTH)) {
+			return invalid("bad layer name");
+		}
+		layers.push_back({ entry.name, reinterpret_cast<uint16_t*>(data + entry.tilesOffset) });
+	}
+
+	LOG_DEBUG(Assets, "Tilemap \"{}\" mapped: {}x{} tiles, {} layers", filePath, header.width, header.height, header.numLayers);
+	return std::make_unique<Tilemap>(
+		static_cast<int>(header.width), static_cast<int>(header.height), static_cast<int>(header.tileSize), header.tileScale,
+		header.tilesetId, header.tilesetPath, static_cast<int>(header.tilesetColumns), std::move(file), layers
+	);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+#include "Tilemap.h"
+
+// binary tilemap format, compiled from the text .map files
+// the file is mapped into memory and the layers of the Tilemap point straight into it,
+// so loading costs the page faults of the tiles which get used and nothing gets parsed
+//
+// layout (little endian, like every platform we build for):
+//   Header
+//   LayerEntry[numLayers]
+//   per layer: width * height uint16_t tile indices (Tilemap::EMPTY_TILE for no tile), aligned to DATA_ALIGNMENT
+//
+// text format (.map):
+//   # comment
+//   tileset <asset id> <image path> <tile size> <tiles per row>
+//   scale <tile scale>
+//   layer <name>
+//   21,21,08,...   one line per row of tiles, the index in the tileset (row by row), -1 or nothing for no tile
+// the rows before the first "layer" line belong to a layer called "ground", all the layers have the same size
+namespace TilemapFile {
+	constexpr char MAGIC[4] = { 'J', 'T', 'M', 'P' };
+	constexpr uint32_t VERSION = 1;
+	// reads as 0x04030201 on a machine with the other byte order
+	constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+	constexpr size_t MAX_NAME_LENGTH = 64;
+	constexpr size_t MAX_PATH_LENGTH = 256;
+	constexpr size_t DATA_ALIGNMENT = 64;
+
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint32_t byteOrderMark;
+		uint32_t width; // in tiles
+		uint32_t height;
+		uint32_t tileSize; // in pixels of the tileset
+		float tileScale;
+		uint32_t tilesetColumns;
+		uint32_t numLayers;
+		uint32_t reserved;
+		uint64_t layersOffset; // of the LayerEntry table
+		uint64_t fileSize;
+		char tilesetId[MAX_NAME_LENGTH]; // zero terminated
+		char tilesetPath[MAX_PATH_LENGTH];
+	};
+
+	struct LayerEntry {
+		char name[MAX_NAME_LENGTH]; // zero terminated
+		uint64_t tilesOffset;
+	};
+
+	static_assert(std::is_trivially_copyable<Header>::value && std::is_trivially_copyable<LayerEntry>::value, "the file structs get copied byte by byte");
+
+	// compiles a text map into the binary format, false (and logged) on errors
+	bool Compile(const std::string& sourcePath, const std::string& targetPath);
+	// true if the binary map is missing or older than the text map
+	bool IsOutdated(const std::string& sourcePath, const std::string& targetPath);
+	// maps the binary map, nullptr (and logged) if it is missing or invalid
+	std::unique_ptr<Tilemap> Load(const std::string& filePath);
+}
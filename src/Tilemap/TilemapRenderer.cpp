@@ -0,0 +1,192 @@
+#include "TilemapRenderer.h"
+#include <cmath>
+#include <algorithm>
+#include "../Logger/Logger.h"
+
+TilemapRenderer::~TilemapRenderer() {
+	Clear();
+}
+
+void TilemapRenderer::Reset(const Tilemap& tilemap) {
+	const int newTextureSize = Tilemap::CHUNK_TILES * tilemap.GetTileSize();
+	if (newTextureSize != textureSize) {
+		Clear();
+		textureSize = newTextureSize;
+	}
+	for (CachedChunk& cached : cache) {
+		cached.chunk = -1;
+	}
+	chunks.assign(static_cast<size_t>(tilemap.GetNumChunksX()) * tilemap.GetNumChunksY(), ChunkState());
+	this->tilemap = &tilemap;
+}
+
+bool TilemapRenderer::IsEmpty(const Tilemap& tilemap, int chunkX, int chunkY) {
+	ChunkState& state = chunks[static_cast<size_t>(chunkY) * tilemap.GetNumChunksX() + chunkX];
+	const uint32_t version = tilemap.GetChunkVersion(chunkX, chunkY);
+	if (!state.isEmptyChecked || state.emptyCheckedVersion != version) {
+		state.isEmpty = tilemap.IsChunkEmpty(chunkX, chunkY);
+		state.isEmptyChecked = true;
+		state.emptyCheckedVersion = version;
+	}
+	return state.isEmpty;
+}
+
+int TilemapRenderer::AcquireCacheEntry(SDL_Renderer* renderer) {
+	// a free texture first, then a new one, then the one unused the longest
+	for (size_t i = 0; i < cache.size(); i++) {
+		if (cache[i].chunk == -1) {
+			return static_cast<int>(i);
+		}
+	}
+	if (cache.size() >= MAX_CACHED_CHUNKS) {
+		int oldest = -1;
+		for (size_t i = 0; i < cache.size(); i++) {
+			if (cache[i].lastUsedFrame < frame && (oldest == -1 || cache[i].lastUsedFrame < cache[oldest].lastUsedFrame)) {
+				oldest = static_cast<int>(i);
+			}
+		}
+		if (oldest != -1) {
+			return oldest;
+		}
+		// more chunks visible than the cache holds (zoomed far out), it grows
+	}
+
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, textureSize, textureSize);
+	if (!texture) {
+		LOG_ERROR(Render, "Error creating a tilemap chunk texture: {}", SDL_GetError());
+		return -1;
+	}
+	// empty tiles stay transparent
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	cache.emplace_back();
+	cache.back().texture = texture;
+	return static_cast<int>(cache.size()) - 1;
+}
+
+void TilemapRenderer::Bake(SDL_Renderer* renderer, const Tilemap& tilemap, SDL_Texture* tileset, int chunkX, int chunkY, SDL_Texture* target) {
+	SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+	Uint8 r, g, b, a;
+	SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+	SDL_SetRenderTarget(renderer, target);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+
+	// all the tiles of all the layers of the chunk in one draw call, the quads keep their order
+	const SDL_Rect chunk = tilemap.GetChunkTiles(chunkX, chunkY);
+	const float tileSize = static_cast<float>(tilemap.GetTileSize());
+	spriteBatch.Begin();
+	for (int layer = 0; layer < tilemap.GetNumLayers(); layer++) {
+		for (int y = 0; y < chunk.h; y++) {
+			for (int x = 0; x < chunk.w; x++) {
+				const uint16_t tile = tilemap.GetTile(chunk.x + x, chunk.y + y, layer);
+				if (tile != Tilemap::EMPTY_TILE) {
+					spriteBatch.Draw(tileset, tilemap.GetTileRect(tile), { x * tileSize, y * tileSize, tileSize, tileSize });
+				}
+			}
+		}
+	}
+	spriteBatch.End(renderer);
+
+	SDL_SetRenderTarget(renderer, previousTarget);
+	SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	numBakes++;
+}
+
+SDL_Texture* TilemapRenderer::GetTexture(SDL_Renderer* renderer, const Tilemap& tilemap, SDL_Texture* tileset, int chunkX, int chunkY) {
+	const int chunkIndex = chunkY * tilemap.GetNumChunksX() + chunkX;
+	const uint32_t version = tilemap.GetChunkVersion(chunkX, chunkY);
+
+	if (chunks[chunkIndex].cacheIndex == -1) {
+		const int cacheIndex = AcquireCacheEntry(renderer);
+		if (cacheIndex == -1) {
+			return nullptr;
+		}
+		CachedChunk& cached = cache[cacheIndex];
+		if (cached.chunk != -1) {
+			chunks[cached.chunk].cacheIndex = -1;
+		}
+		cached.chunk = chunkIndex;
+		cached.version = version;
+		chunks[chunkIndex].cacheIndex = cacheIndex;
+		Bake(renderer, tilemap, tileset, chunkX, chunkY, cached.texture);
+	}
+
+	CachedChunk& cached = cache[chunks[chunkIndex].cacheIndex];
+	if (cached.version != version) {
+		cached.version = version;
+		Bake(renderer, tilemap, tileset, chunkX, chunkY, cached.texture);
+	}
+	cached.lastUsedFrame = frame;
+	return cached.texture;
+}
+
+void TilemapRenderer::Render(SDL_Renderer* renderer, const Tilemap& tilemap, SDL_Texture* tileset, const CameraComponent& camera) {
+	numBakes = 0;
+	numDrawnChunks = 0;
+	if (!tileset) {
+		return;
+	}
+	if (this->tilemap != &tilemap || chunks.size() != static_cast<size_t>(tilemap.GetNumChunksX()) * tilemap.GetNumChunksY()) {
+		Reset(tilemap);
+	}
+	frame++;
+
+	const float worldTileSize = tilemap.GetWorldTileSize();
+	const float chunkWorldSize = Tilemap::CHUNK_TILES * worldTileSize;
+	const SDL_FRect view = camera.GetWorldRect();
+	const int firstX = std::max(0, static_cast<int>(std::floor(view.x / chunkWorldSize)));
+	const int firstY = std::max(0, static_cast<int>(std::floor(view.y / chunkWorldSize)));
+	const int lastX = std::min(tilemap.GetNumChunksX() - 1, static_cast<int>(std::floor((view.x + view.w) / chunkWorldSize)));
+	const int lastY = std::min(tilemap.GetNumChunksY() - 1, static_cast<int>(std::floor((view.y + view.h) / chunkWorldSize)));
+
+	for (int chunkY = firstY; chunkY <= lastY; chunkY++) {
+		for (int chunkX = firstX; chunkX <= lastX; chunkX++) {
+			if (IsEmpty(tilemap, chunkX, chunkY)) {
+				continue;
+			}
+			SDL_Texture* texture = GetTexture(renderer, tilemap, tileset, chunkX, chunkY);
+			if (!texture) {
+				continue;
+			}
+
+			// the chunks at the right and bottom edge only use a part of their texture
+			const SDL_Rect tiles = tilemap.GetChunkTiles(chunkX, chunkY);
+			const SDL_Rect srcRect = { 0, 0, tiles.w * tilemap.GetTileSize(), tiles.h * tilemap.GetTileSize() };
+			const SDL_FRect dstRect = {
+				(chunkX * chunkWorldSize - camera.position.x) * camera.zoom,
+				(chunkY * chunkWorldSize - camera.position.y) * camera.zoom,
+				tiles.w * worldTileSize * camera.zoom,
+				tiles.h * worldTileSize * camera.zoom
+			};
+			SDL_RenderCopyF(renderer, texture, &srcRect, &dstRect);
+			numDrawnChunks++;
+		}
+	}
+}
+
+void TilemapRenderer::Invalidate() {
+	for (CachedChunk& cached : cache) {
+		if (cached.chunk != -1) {
+			chunks[cached.chunk].cacheIndex = -1;
+			cached.chunk = -1;
+		}
+	}
+}
+
+void TilemapRenderer::Clear() {
+	for (CachedChunk& cached : cache) {
+		SDL_DestroyTexture(cached.texture);
+	}
+	cache.clear();
+	chunks.clear();
+	tilemap = nullptr;
+}
+
+int TilemapRenderer::GetNumBakes() const {
+	return numBakes;
+}
+
+int TilemapRenderer::GetNumDrawnChunks() const {
+	return numDrawnChunks;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <SDL.h>
+#include "Tilemap.h"
+#include "../Renderer/SpriteBatch.h"
+#include "../Components/CameraComponent.h"
+
+// draws a tilemap with one copy per visible chunk
+// every chunk gets drawn (baked) once into a render target texture at the resolution of the tileset
+// and is only baked again when its tiles changed, so a frame costs O(visible chunks) no matter how big the map is
+// the textures of chunks which went out of view are reused for the newly visible ones
+class TilemapRenderer {
+private:
+	// textures kept for reuse, when more chunks are visible at once the cache grows
+	static constexpr int MAX_CACHED_CHUNKS = 64;
+
+	struct CachedChunk {
+		SDL_Texture* texture = nullptr;
+		int chunk = -1; // index of the chunk the texture shows or -1
+		uint32_t version = 0; // version of the chunk when it was baked
+		uint64_t lastUsedFrame = 0;
+	};
+
+	struct ChunkState {
+		int cacheIndex = -1; // in cache or -1
+		bool isEmptyChecked = false;
+		bool isEmpty = false;
+		uint32_t emptyCheckedVersion = 0;
+	};
+
+	std::vector<CachedChunk> cache;
+	std::vector<ChunkState> chunks; // [chunk y * number of chunks x + chunk x]
+	const Tilemap* tilemap = nullptr; // the map the cache belongs to
+	int textureSize = 0; // width and height of a chunk texture
+	SpriteBatch spriteBatch; // draws the tiles of a chunk while baking
+	uint64_t frame = 0;
+	int numBakes = 0;
+	int numDrawnChunks = 0;
+
+	void Reset(const Tilemap& tilemap);
+	bool IsEmpty(const Tilemap& tilemap, int chunkX, int chunkY);
+	// the cached texture of the chunk, baked again if it is outdated, nullptr if no texture could be created
+	SDL_Texture* GetTexture(SDL_Renderer* renderer, const Tilemap& tilemap, SDL_Texture* tileset, int chunkX, int chunkY);
+	// the cache entry for a chunk without one, -1 if no texture could be created
+	int AcquireCacheEntry(SDL_Renderer* renderer);
+	void Bake(SDL_Renderer* renderer, const Tilemap& tilemap, SDL_Texture* tileset, int chunkX, int chunkY, SDL_Texture* target);
+
+public:
+	TilemapRenderer() = default;
+	~TilemapRenderer();
+	TilemapRenderer(const TilemapRenderer&) = delete;
+	TilemapRenderer& operator =(const TilemapRenderer&) = delete;
+
+	// draws the chunks the camera sees
+	void Render(SDL_Renderer* renderer, const Tilemap& tilemap, SDL_Texture* tileset, const CameraComponent& camera);
+	// bakes every chunk again, needed after SDL_RENDER_TARGETS_RESET (the content of render targets got lost)
+	void Invalidate();
+	// frees the textures, has to happen before the renderer gets destroyed
+	// and after SDL_RENDER_DEVICE_RESET, the chunks get new textures when they are drawn again
+	void Clear();
+
+	// statistics of the last Render()
+	int GetNumBakes() const;
+	int GetNumDrawnChunks() const;
+};